@@ -0,0 +1,151 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Bench
+*/
+
+#ifndef BENCH_HPP_
+#define BENCH_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+    /**
+     * @brief Measures of one benchmark
+     *
+     */
+    struct result {
+        std::string name;
+        std::size_t size;
+        std::size_t ops;
+        double min_ns;
+        double median_ns;
+    };
+
+    /**
+     * @brief Run benchmarks, print them in a table and optionally write them in a JSON file to compare versions.
+     * Options: --json <file>, --filter <substring of the names>, --quick (a single short sample per benchmark)
+     *
+     */
+    class suite {
+    public:
+        /**
+         * @brief Construct a new suite object from the command line
+         *
+         * @param argc
+         * @param argv
+         */
+        suite(int argc, char **argv)
+        {
+            for (int i = 1; i < argc; i++) {
+                if (!std::strcmp(argv[i], "--json") && i + 1 < argc)
+                    _json = argv[++i];
+                else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc)
+                    _filter = argv[++i];
+                else if (!std::strcmp(argv[i], "--quick"))
+                    _quick = true;
+                else
+                    std::fprintf(stderr, "Unknown option %s\n", argv[i]);
+            }
+            std::printf("%-48s %10s %10s %14s %14s\n", "benchmark", "size", "ops", "min ns/op", "median ns/op");
+        }
+
+        /**
+         * @brief Check if the suite runs with --quick, benchmarks can use it to shrink their sizes
+         *
+         * @return true if quick
+         */
+        bool quick() const
+        {
+            return _quick;
+        }
+
+        /**
+         * @brief Measure a function. It is called once to warm up, then sampled several times.
+         * Each call must do ops operations and leave the state as it found it.
+         *
+         * @tparam Function
+         * @param name of the benchmark
+         * @param size number of entities or elements involved
+         * @param ops number of operations done by each call
+         * @param f function to measure
+         */
+        template <typename Function> void run(std::string const &name, std::size_t size, std::size_t ops, Function &&f)
+        {
+            if (!_filter.empty() && name.find(_filter) == std::string::npos)
+                return;
+            std::vector<double> samples;
+            auto budget = std::chrono::milliseconds(_quick ? 0 : 200);
+            auto start = std::chrono::steady_clock::now();
+
+            f();
+            do {
+                auto begin = std::chrono::steady_clock::now();
+
+                f();
+                samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / ops);
+            } while (samples.size() < (_quick ? 1u : 5u) || (std::chrono::steady_clock::now() - start < budget && samples.size() < 100));
+            std::sort(samples.begin(), samples.end());
+            _results.push_back({name, size, ops, samples.front(), samples[samples.size() / 2]});
+            std::printf("%-48s %10zu %10zu %14.2f %14.2f\n", name.c_str(), size, ops, samples.front(), samples[samples.size() / 2]);
+            std::fflush(stdout);
+        }
+
+        /**
+         * @brief Write the JSON file if one was asked
+         *
+         * @return int exit code
+         */
+        int finish() const
+        {
+            if (_json.empty())
+                return 0;
+            std::ofstream out(_json);
+
+            if (!out) {
+                std::fprintf(stderr, "Cannot open %s\n", _json.c_str());
+                return 1;
+            }
+            out << "{\n  \"benchmarks\": [\n";
+            for (std::size_t i = 0; i < _results.size(); i++) {
+                auto const &r = _results[i];
+
+                out << "    {\"name\": \"" << r.name << "\", \"size\": " << r.size << ", \"ops\": " << r.ops
+                    << ", \"min_ns_per_op\": " << r.min_ns << ", \"median_ns_per_op\": " << r.median_ns << "}"
+                    << (i + 1 < _results.size() ? ",\n" : "\n");
+            }
+            out << "  ]\n}\n";
+            return 0;
+        }
+
+    private:
+        std::string _json;
+        std::string _filter;
+        bool _quick = false;
+        std::vector<result> _results;
+    };
+
+    namespace detail {
+        inline volatile char sink;
+    }
+
+    /**
+     * @brief Keep a value alive so the compiler does not remove the computation of a benchmark
+     *
+     * @tparam T
+     * @param value
+     */
+    template <typename T> void keep(T const &value)
+    {
+        detail::sink = *reinterpret_cast<char const volatile *>(&value);
+    }
+}
+
+#endif /* !BENCH_HPP_ */
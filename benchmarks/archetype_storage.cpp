@@ -0,0 +1,97 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** archetype_storage benchmark
+*/
+
+// Compare the archetype storage with the sparse_array layout, for iteration and structural changes.
+// Built by the archetype_bench target, takes the same options as ecs_bench.
+
+#include "Bench.hpp"
+#include "Registry.hpp"
+#include "Zipper.hpp"
+
+namespace sparse {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+    struct sprite { int texture, frame; };
+    struct hitbox { float w, h; };
+}
+
+namespace table {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+    struct sprite { int texture, frame; };
+    struct hitbox { float w, h; };
+}
+
+template <> struct ecs::component_storage<table::position> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<table::velocity> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<table::sprite> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<table::hitbox> { using type = ecs::archetype_storage; };
+
+template <class Position, class Velocity, class Sprite, class Hitbox>
+static void populate(ecs::registry &reg, std::size_t count)
+{
+    reg.register_component<Position>();
+    reg.register_component<Velocity>();
+    reg.register_component<Sprite>();
+    reg.register_component<Hitbox>();
+    for (std::size_t i = 0; i < count; i++) {
+        ecs::entity e = reg.spawn_entity();
+
+        reg.add_component<Position>(e, {float(i), 0});
+        reg.add_component<Velocity>(e, {1, 1});
+        reg.add_component<Sprite>(e, {0, 0});
+        reg.add_component<Hitbox>(e, {1, 1});
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::suite suite(argc, argv);
+
+    for (std::size_t count : {1000, 10000, 100000}) {
+        ecs::registry sparse_reg;
+        ecs::registry table_reg;
+        std::string suffix = "/" + std::to_string(count);
+
+        if (suite.quick() && count > 1000)
+            break;
+        populate<sparse::position, sparse::velocity, sparse::sprite, sparse::hitbox>(sparse_reg, count);
+        populate<table::position, table::velocity, table::sprite, table::hitbox>(table_reg, count);
+
+        auto &positions = sparse_reg.get_components<sparse::position>();
+        auto &velocities = sparse_reg.get_components<sparse::velocity>();
+        auto &sprites = sparse_reg.get_components<sparse::sprite>();
+        auto &hitboxes = sparse_reg.get_components<sparse::hitbox>();
+
+        suite.run("iterate_4/sparse_array" + suffix, count, count, [&]() {
+            for (auto [id, pos, vel, spr, hit] : ecs::zipper(positions, velocities, sprites, hitboxes)) {
+                pos.x += vel.x * hit.w;
+                spr.frame++;
+            }
+        });
+        suite.run("iterate_4/archetype" + suffix, count, count, [&]() {
+            table_reg.archetypes().each<table::position, table::velocity, table::sprite, table::hitbox>(
+                [](std::size_t, table::position &pos, table::velocity &vel, table::sprite &spr, table::hitbox &hit) {
+                    pos.x += vel.x * hit.w;
+                    spr.frame++;
+                });
+        });
+        suite.run("remove_add/sparse_array" + suffix, count, count * 2, [&]() {
+            for (std::size_t i = 0; i < count; i++)
+                sparse_reg.remove_component<sparse::velocity>(sparse_reg.entity_from_index(i));
+            for (std::size_t i = 0; i < count; i++)
+                sparse_reg.add_component<sparse::velocity>(sparse_reg.entity_from_index(i), {1, 1});
+        });
+        suite.run("remove_add/archetype" + suffix, count, count * 2, [&]() {
+            for (std::size_t i = 0; i < count; i++)
+                table_reg.remove_component<table::velocity>(table_reg.entity_from_index(i));
+            for (std::size_t i = 0; i < count; i++)
+                table_reg.add_component<table::velocity>(table_reg.entity_from_index(i), {1, 1});
+        });
+    }
+    return suite.finish();
+}
@@ -0,0 +1,106 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** broadphase benchmark
+*/
+
+// Compare the spatial_grid with the pairwise loop over the positions, to find the overlapping hitboxes of a frame.
+// Built by the broadphase_bench target, takes the same options as ecs_bench.
+
+#include <cstdint>
+#include "Bench.hpp"
+#include "Registry.hpp"
+#include "Spatial_grid.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct position { float x, y; };
+    struct hitbox { float w, h; };
+}
+
+template <> struct ecs::track_changes<position> : std::true_type {};
+
+namespace {
+    // Deterministic pseudo random floats in [0, 1)
+    float noise(std::uint64_t idx, std::uint64_t salt)
+    {
+        std::uint64_t h = (idx + 1) * 0x9E3779B97F4A7C15ull ^ (salt + 1) * 0xC2B2AE3D27D4EB4Full;
+
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return float(h % 1000000) / 1000000.0f;
+    }
+
+    ecs::aabb bounds(position const &pos, hitbox const &box)
+    {
+        return ecs::aabb{pos.x, pos.y, pos.x + box.w, pos.y + box.h};
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::suite suite(argc, argv);
+
+    for (std::size_t count : {1000, 10000, 50000}) {
+        ecs::registry reg;
+        auto &positions = reg.register_component<position>();
+        auto &hitboxes = reg.register_component<hitbox>();
+        // same density at every size: about one entity per 24x24 area
+        float side = std::sqrt(float(count)) * 24;
+        std::string suffix = "/" + std::to_string(count);
+        std::size_t moving = count / 10;
+        std::vector<ecs::entity> frame;
+        std::size_t pairs = 0;
+
+        if (suite.quick() && count > 1000)
+            break;
+        for (std::size_t i = 0; i < count; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{noise(i, 0) * side, noise(i, 1) * side});
+            reg.add_component(e, hitbox{4 + noise(i, 2) * 12, 4 + noise(i, 3) * 12});
+        }
+        suite.run("pairs/brute_force" + suffix, count, count, [&]() {
+            for (auto [a, pos_a, box_a] : ecs::zipper(std::as_const(positions), std::as_const(hitboxes))) {
+                ecs::aabb first = bounds(pos_a, box_a);
+
+                for (auto [b, pos_b, box_b] : ecs::zipper(std::as_const(positions), std::as_const(hitboxes))) {
+                    if (b > a && first.overlaps(bounds(pos_b, box_b)))
+                        pairs++;
+                }
+            }
+        });
+
+        auto &grid = reg.set_resource<ecs::spatial_grid>(16.f);
+        auto box_of = [&hitboxes](std::size_t e, position const &pos) { return bounds(pos, hitboxes.get(e)); };
+        ecs::tick_t synced = 0;
+        std::size_t next = 0;
+
+        grid.sync(positions, synced, box_of);
+        synced = reg.tick();
+        suite.run("pairs/grid_sync_10pct_moving" + suffix, count, count, [&]() {
+            // a tenth of the entities move each frame, the grid only updates them
+            reg.run_systems(frame);
+            for (std::size_t i = 0; i < moving; i++, next = (next + 1) % count) {
+                position &pos = positions.get(next);
+
+                pos.x = pos.x + 1 < side ? pos.x + 1 : 0;
+            }
+            grid.sync(positions, synced, box_of);
+            synced = reg.tick();
+            grid.for_each_overlapping_pair([&pairs](std::size_t, std::size_t) { pairs++; });
+        });
+        suite.run("query_aabb/grid" + suffix, count, count, [&]() {
+            for (std::size_t i = 0; i < count; i++) {
+                float x = noise(i, 4) * side;
+                float y = noise(i, 5) * side;
+
+                grid.query_aabb(ecs::aabb{x, y, x + 16, y + 16}, [&pairs](std::size_t) { pairs++; });
+            }
+        });
+        bench::keep(pairs);
+    }
+    return suite.finish();
+}
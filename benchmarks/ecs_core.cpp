@@ -0,0 +1,444 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** ecs_core benchmark
+*/
+
+// Benchmarks of the core of the ECS: entities, components, zipper, systems, events, snapshots and sorting.
+// Run ./ecs_bench --json results.json to keep the results and compare them with another version.
+
+#include <cstdint>
+#include "Bench.hpp"
+#include "Registry.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct soa_position { float x, y; };
+    struct soa_velocity { float x, y; };
+    struct depth { std::uint32_t z; };
+}
+
+template <> struct ecs::soa_fields<soa_position> { static constexpr auto fields = std::make_tuple(&soa_position::x, &soa_position::y); };
+template <> struct ecs::soa_fields<soa_velocity> { static constexpr auto fields = std::make_tuple(&soa_velocity::x, &soa_velocity::y); };
+template <> struct ecs::component_storage<soa_position> { using type = ecs::soa_array<soa_position>; };
+template <> struct ecs::component_storage<soa_velocity> { using type = ecs::soa_array<soa_velocity>; };
+template <> struct ecs::component_storage<depth> { using type = ecs::packed_array<depth>; };
+
+namespace {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+    struct health { int value; };
+
+    struct dense_a { float value; };
+    struct dense_b { float value; };
+    struct dense_c { float value; };
+
+    struct object { float x, y; };
+
+    position position_from_object(object &o)
+    {
+        return position{o.x, o.y};
+    }
+
+    // Deterministic choice of the entities having a component, independent for each component
+    bool present(std::size_t idx, std::size_t salt, double density)
+    {
+        std::uint64_t h = (idx + 1) * 0x9E3779B97F4A7C15ull ^ (salt + 1) * 0xC2B2AE3D27D4EB4Full;
+
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        h ^= h >> 29;
+        return double(h % 1000000) < density * 1000000.0;
+    }
+
+    void entities(bench::suite &suite, std::size_t count)
+    {
+        ecs::registry reg;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        std::vector<ecs::entity> spawned;
+        spawned.reserve(count);
+        suite.run("spawn_kill/churn", count, count, [&]() {
+            for (std::size_t i = 0; i < count; i++) {
+                spawned.push_back(reg.spawn_entity());
+                reg.add_component(spawned.back(), position{float(i), 0});
+            }
+            for (auto e : spawned)
+                reg.kill_entity(e);
+            spawned.clear();
+        });
+
+        std::vector<position> positions(count, position{1, 0});
+        suite.run("spawn_kill/bulk", count, count, [&]() {
+            std::vector<ecs::entity> wave = reg.spawn_entities(count);
+
+            reg.add_components<position>(wave, positions);
+            for (auto e : wave)
+                reg.kill_entity(e);
+        });
+
+        suite.run("spawn_kill/staged", count, count, [&]() {
+            for (std::size_t i = 0; i < count; i++) {
+                spawned.push_back(reg.spawn_entity());
+                reg.stage_component(spawned.back(), position{float(i), 0});
+            }
+            reg.merge_staged();
+            for (auto e : spawned)
+                reg.kill_entity(e);
+            spawned.clear();
+        });
+
+        for (std::size_t i = 0; i < count; i++)
+            reg.add_component(reg.spawn_entity(), position{float(i), 0});
+        suite.run("add_remove/component", count, count * 2, [&]() {
+            for (std::size_t i = 0; i < count; i++)
+                reg.add_component(reg.entity_from_index(i), velocity{1, 1});
+            for (std::size_t i = 0; i < count; i++)
+                reg.remove_component<velocity>(reg.entity_from_index(i));
+        });
+    }
+
+    void zipper(bench::suite &suite, std::size_t count)
+    {
+        for (double density : {1.0, 0.5, 0.1, 0.01}) {
+            ecs::registry reg;
+            auto &a = reg.register_component<dense_a>();
+            auto &b = reg.register_component<dense_b>();
+            auto &c = reg.register_component<dense_c>();
+            std::string suffix = "/density_" + std::to_string(int(density * 100));
+
+            for (std::size_t i = 0; i < count; i++) {
+                ecs::entity e = reg.spawn_entity();
+
+                if (present(i, 0, density))
+                    reg.add_component(e, dense_a{1});
+                if (present(i, 1, density))
+                    reg.add_component(e, dense_b{1});
+                if (present(i, 2, density))
+                    reg.add_component(e, dense_c{1});
+            }
+            suite.run("zipper/arity_1" + suffix, count, count, [&]() {
+                float sum = 0;
+
+                for (auto [id, va] : ecs::zipper(a))
+                    sum += va.value;
+                bench::keep(sum);
+            });
+            suite.run("zipper/arity_2" + suffix, count, count, [&]() {
+                float sum = 0;
+
+                for (auto [id, va, vb] : ecs::zipper(a, b))
+                    sum += va.value + vb.value;
+                bench::keep(sum);
+            });
+            suite.run("zipper/arity_3" + suffix, count, count, [&]() {
+                float sum = 0;
+
+                for (auto [id, va, vb, vc] : ecs::zipper(a, b, c))
+                    sum += va.value + vb.value + vc.value;
+                bench::keep(sum);
+            });
+            auto &group = reg.get_group<dense_a const, dense_b const>();
+            suite.run("group/arity_2" + suffix, count, count, [&]() {
+                float sum = 0;
+
+                group.each([&sum](ecs::entity, dense_a const &va, dense_b const &vb) { sum += va.value + vb.value; });
+                bench::keep(sum);
+            });
+        }
+        // few components on a wide index range joined with many on a short one, the walk stops at the short range
+        ecs::sparse_array<dense_a> wide;
+        ecs::sparse_array<dense_b> narrow;
+
+        for (std::size_t i = 0; i < 10; i++)
+            wide.insert_at(count * 10 - 1 - i * count / 10, dense_a{1});
+        for (std::size_t i = 0; i < count / 100; i++)
+            narrow.insert_at(i, dense_b{1});
+        suite.run("zipper/sparse_different_sizes", count * 10, count / 100, [&]() {
+            float sum = 0;
+
+            for (auto [id, va, vb] : ecs::zipper(wide, narrow))
+                sum += va.value + vb.value;
+            bench::keep(sum);
+        });
+    }
+
+    void movement(bench::suite &suite, std::size_t count)
+    {
+        ecs::registry reg;
+        auto &positions = reg.register_component<position>();
+        auto &velocities = reg.register_component<velocity>();
+        auto &soa_positions = reg.register_component<soa_position>();
+        auto &soa_velocities = reg.register_component<soa_velocity>();
+        float dt = 0.016f;
+
+        for (std::size_t i = 0; i < count; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{float(i), 0});
+            reg.add_component(e, velocity{1, 1});
+            reg.add_component(e, soa_position{float(i), 0});
+            reg.add_component(e, soa_velocity{1, 1});
+        }
+        suite.run("movement/sparse_array_zipper", count, count, [&]() {
+            for (auto [id, pos, vel] : ecs::zipper(positions, velocities)) {
+                pos.x += vel.x * dt;
+                pos.y += vel.y * dt;
+            }
+        });
+        std::size_t packed = soa_positions.pack_with(soa_velocities);
+        suite.run("movement/soa_spans", count, count, [&]() {
+            auto px = soa_positions.field<&soa_position::x>();
+            auto py = soa_positions.field<&soa_position::y>();
+            auto vx = soa_velocities.field<&soa_velocity::x>();
+            auto vy = soa_velocities.field<&soa_velocity::y>();
+
+            for (std::size_t i = 0; i < packed; i++) {
+                px[i] += vx[i] * dt;
+                py[i] += vy[i] * dt;
+            }
+        });
+    }
+
+    void reverse_lookup(bench::suite &suite, std::size_t count)
+    {
+        ecs::sparse_array<position> positions;
+        auto const &slots = positions;
+        std::vector<std::optional<position> const *> components;
+        std::string suffix = "/entities_" + std::to_string(count);
+
+        for (std::size_t i = 0; i < count; i++)
+            positions.insert_at(i, position{float(i), 0});
+        for (std::size_t i = 0; i < count; i += count / 64)
+            components.push_back(&slots[i]);
+        suite.run("get_index/sparse_array" + suffix, count, components.size(), [&]() {
+            std::size_t sum = 0;
+
+            for (auto component : components)
+                sum += positions.get_index(*component);
+            bench::keep(sum);
+        });
+        // What get_index cost when it compared the address with every slot
+        suite.run("get_index/linear_scan" + suffix, count, components.size(), [&]() {
+            std::size_t sum = 0;
+
+            for (auto component : components) {
+                for (std::size_t i = 0; i < positions.size(); i++) {
+                    if (&slots[i] == component) {
+                        sum += i;
+                        break;
+                    }
+                }
+            }
+            bench::keep(sum);
+        });
+    }
+
+    void systems(bench::suite &suite, std::size_t system_count, std::size_t entity_count)
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        for (std::size_t i = 0; i < entity_count; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{0, 0});
+            reg.add_component(e, velocity{1, 1});
+        }
+        for (std::size_t i = 0; i < system_count; i++) {
+            reg.add_system<position, velocity const>([](ecs::registry &, std::vector<ecs::entity> &,
+                ecs::sparse_array<position> &positions, ecs::sparse_array<velocity> const &velocities) {
+                for (auto [id, pos, vel] : ecs::zipper(positions, velocities)) {
+                    pos.x += vel.x;
+                    pos.y += vel.y;
+                }
+            }, int(i % 4));
+        }
+        suite.run("run_systems/small_systems", entity_count, system_count, [&]() {
+            reg.run_systems(entities);
+        });
+    }
+
+    void events(bench::suite &suite, std::size_t triggers)
+    {
+        for (std::size_t handlers : {1, 16, 256}) {
+            ecs::registry reg;
+            std::vector<ecs::entity> entities;
+            int hits = 0;
+            std::string suffix = "/handlers_" + std::to_string(handlers);
+
+            for (std::size_t i = 0; i < handlers; i++)
+                reg.add_event<int>("hit", [&hits](ecs::registry &, std::vector<ecs::entity> &, int damage) { hits += damage; });
+            suite.run("trigger_event/by_name" + suffix, handlers, triggers, [&]() {
+                for (std::size_t i = 0; i < triggers; i++)
+                    reg.trigger_event<int>("hit", entities, 1);
+            });
+            auto &channel = reg.get_event<int>("hit");
+            suite.run("trigger_event/channel" + suffix, handlers, triggers, [&]() {
+                for (std::size_t i = 0; i < triggers; i++)
+                    channel.trigger(reg, entities, 1);
+            });
+            bench::keep(hits);
+        }
+        // a payload expensive to copy, given to every handler
+        for (std::size_t handlers : {1, 16}) {
+            ecs::registry reg;
+            std::vector<ecs::entity> entities;
+            std::vector<int> payload(1024, 1);
+            std::size_t seen = 0;
+            auto &channel = reg.get_event<std::vector<int>>("wave");
+
+            for (std::size_t i = 0; i < handlers; i++)
+                channel.subscribe([&seen](ecs::registry &, std::vector<ecs::entity> &, std::vector<int> const &ids) { seen += ids.size(); });
+            suite.run("trigger_event/heavy_payload/handlers_" + std::to_string(handlers), handlers, triggers, [&]() {
+                for (std::size_t i = 0; i < triggers; i++)
+                    channel.trigger(reg, entities, payload);
+            });
+            bench::keep(seen);
+        }
+    }
+
+    void named_components(bench::suite &suite, std::size_t count)
+    {
+        ecs::registry reg;
+        object o{1, 2};
+
+        reg.register_component<position, object>("position", position_from_object);
+        for (std::size_t i = 0; i < count; i++)
+            reg.spawn_entity();
+        suite.run("add_component/by_name", count, count, [&]() {
+            for (std::size_t i = 0; i < count; i++)
+                reg.add_component<object>("position", reg.entity_from_index(i), o);
+        });
+
+        ecs::registry::prefab prefab;
+        reg.add_component("position", prefab, o);
+        std::vector<ecs::entity> targets = reg.spawn_entities(count);
+        suite.run("add_component/prefab", count, count, [&]() {
+            reg.instantiate(prefab, targets);
+        });
+    }
+
+    template <class Array> void snapshot_array(bench::suite &suite, std::string const &name, std::size_t count)
+    {
+        Array positions;
+        std::vector<std::byte> buffer;
+
+        ecs::binary_writer writer(buffer);
+        Array restored;
+
+        for (std::size_t i = 0; i < count; i++)
+            positions.insert_at(i, position{float(i), 0});
+        positions.snapshot(writer);
+        suite.run("snapshot/" + name, count, count, [&]() {
+            buffer.clear();
+            positions.snapshot(writer);
+            bench::keep(buffer.back());
+        });
+        suite.run("restore/" + name, count, count, [&]() {
+            ecs::binary_reader reader(buffer);
+
+            restored.restore(reader);
+            bench::keep(restored.live_count());
+        });
+    }
+
+    void snapshots(bench::suite &suite, std::size_t count)
+    {
+        snapshot_array<ecs::sparse_array<position>>(suite, "sparse_array", count);
+        snapshot_array<ecs::packed_array<position>>(suite, "packed_array", count);
+
+        ecs::registry reg;
+        std::vector<std::byte> buffer;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.register_component<depth>();
+        for (std::size_t i = 0; i < count; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{float(i), 0});
+            reg.add_component(e, velocity{1, 1});
+            reg.add_component(e, depth{std::uint32_t(i)});
+        }
+        reg.snapshot(buffer);
+        suite.run("snapshot_registry", count, count, [&]() {
+            reg.snapshot(buffer);
+            bench::keep(buffer.back());
+        });
+        suite.run("restore_registry", count, count, [&]() {
+            reg.restore(buffer);
+            bench::keep(reg.get_components<depth>().live_count());
+        });
+    }
+
+    void sorting(bench::suite &suite, std::size_t count)
+    {
+        ecs::registry reg;
+        auto &depths = reg.register_component<depth>();
+        auto by_z = [](depth const &a, depth const &b) { return a.z < b.z; };
+        std::vector<std::pair<std::uint32_t, std::size_t>> copied;
+        std::uint32_t frame = 0;
+
+        for (std::size_t i = 0; i < count; i++)
+            reg.add_component(reg.spawn_entity(), depth{0});
+        // every z changes, then the pool is walked in z order
+        auto shuffle = [&]() {
+            frame++;
+            for (std::size_t i = 0; i < depths.live_count(); i++)
+                depths.data()[i].z = static_cast<std::uint32_t>((i + 1) * 2654435761u ^ frame * 40503u) % 100000;
+        };
+        // a tenth of the z move by one step, the order is nearly kept
+        auto nudge = [&]() {
+            frame++;
+            for (std::size_t i = frame % 10; i < depths.live_count(); i += 10)
+                depths.data()[i].z += (i / 10 + frame) % 2 ? 1 : -1;
+        };
+        suite.run("sort/copy_and_std_sort", count, count, [&]() {
+            shuffle();
+            copied.clear();
+            for (auto [id, d] : ecs::zipper(std::as_const(depths)))
+                copied.emplace_back(d.z, id);
+            std::sort(copied.begin(), copied.end());
+            bench::keep(copied.front());
+        });
+        suite.run("sort/in_place", count, count, [&]() {
+            shuffle();
+            reg.sort<depth>(by_z);
+            bench::keep(depths.data()[0]);
+        });
+        reg.sort<depth>(by_z);
+        suite.run("sort/in_place_nearly_sorted", count, count, [&]() {
+            nudge();
+            reg.sort<depth>(by_z);
+            bench::keep(depths.data()[0]);
+        });
+        suite.run("sort/insertion_nearly_sorted", count, count, [&]() {
+            nudge();
+            reg.sort<depth>(by_z, ecs::registry::sort_mode::insertion);
+            bench::keep(depths.data()[0]);
+        });
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bench::suite suite(argc, argv);
+    std::size_t count = suite.quick() ? 1000 : 100000;
+
+    entities(suite, count);
+    zipper(suite, count);
+    movement(suite, count);
+    reverse_lookup(suite, count / 10);
+    reverse_lookup(suite, count);
+    systems(suite, suite.quick() ? 16 : 256, 64);
+    events(suite, suite.quick() ? 100 : 10000);
+    named_components(suite, count);
+    snapshots(suite, count);
+    sorting(suite, count);
+    return suite.finish();
+}
@@ -0,0 +1,768 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Archetype
+*/
+
+#ifndef ARCHETYPE_HPP_
+#define ARCHETYPE_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Component_id.hpp"
+#include "Serialization.hpp"
+
+namespace ecs {
+    namespace detail {
+        /**
+         * @brief Read a signature written with binary_writer::write_bits by a registry whose component ids can differ.
+         * Throws a std::runtime_error if it has a component unknown to this registry.
+         *
+         * @param reader to read from
+         * @param ids id in this registry of each id of the writer, -1 for a component this registry did not register
+         * @param order cleared then filled with the ids of the signature in this registry, in the order of the writer
+         * @return signature with the ids of this registry
+         */
+        inline signature read_signature(binary_reader &reader, std::vector<std::size_t> const &ids, std::vector<std::size_t> &order)
+        {
+            signature sig;
+
+            order.clear();
+            reader.for_each_bit([&](std::size_t bit) {
+                if (bit >= ids.size() || ids[bit] == static_cast<std::size_t>(-1))
+                    throw std::runtime_error("Snapshot uses an unregistered component");
+                sig.set(ids[bit]);
+                order.push_back(ids[bit]);
+            });
+            return sig;
+        }
+    }
+
+    /**
+     * @brief Contiguous array of components of one type, whose type is only known when the column is created
+     *
+     */
+    class archetype_column {
+    public:
+        /**
+         * @brief Create an empty column of a component type
+         *
+         * @tparam Component
+         * @return archetype_column
+         */
+        template <class Component> static archetype_column make()
+        {
+            archetype_column column;
+
+            column._size_of = sizeof(Component);
+            column._align = alignof(Component);
+            column._move = [](void *dst, void *src) {
+                new (dst) Component(std::move(*static_cast<Component *>(src)));
+            };
+            column._destroy = [](void *ptr) {
+                static_cast<Component *>(ptr)->~Component();
+            };
+            column._write = [](binary_writer &writer, archetype_column const &from) {
+                write_components(writer, static_cast<Component const *>(from.data()), from.size());
+            };
+            column._read = [](binary_reader &reader, archetype_column &to, std::size_t count) {
+                to.reserve(count);
+                if constexpr (std::is_trivially_copyable_v<Component>) {
+                    reader.read_bytes(to._data, count * sizeof(Component));
+                    to._size = count;
+                } else {
+                    for (std::size_t i = 0; i < count; i++)
+                        new (to.push_uninitialized()) Component(read_component<Component>(reader));
+                }
+            };
+            return column;
+        }
+
+        archetype_column() = default;
+        archetype_column(archetype_column const &) = delete;
+        archetype_column &operator=(archetype_column const &) = delete;
+        /**
+         * @brief Move construct a new archetype column object
+         *
+         * @param from column to move
+         */
+        archetype_column(archetype_column &&from) noexcept
+            : _data(std::exchange(from._data, nullptr)), _size(std::exchange(from._size, 0)), _capacity(std::exchange(from._capacity, 0)),
+            _resizes(std::exchange(from._resizes, 0)), _size_of(from._size_of), _align(from._align), _move(from._move), _destroy(from._destroy), _write(from._write), _read(from._read)
+        {
+        }
+        /**
+         * @brief Move assign a new archetype column object
+         *
+         * @param from column to move
+         */
+        archetype_column &operator=(archetype_column &&from) noexcept
+        {
+            if (this != &from) {
+                release();
+                _data = std::exchange(from._data, nullptr);
+                _size = std::exchange(from._size, 0);
+                _capacity = std::exchange(from._capacity, 0);
+                _resizes = std::exchange(from._resizes, 0);
+                _size_of = from._size_of;
+                _align = from._align;
+                _move = from._move;
+                _destroy = from._destroy;
+                _write = from._write;
+                _read = from._read;
+            }
+            return *this;
+        }
+        /**
+         * @brief Destroy the archetype column object and its components
+         *
+         */
+        ~archetype_column()
+        {
+            release();
+        }
+
+        /**
+         * @brief Create an empty column of the same component type
+         *
+         * @return archetype_column
+         */
+        archetype_column empty_copy() const
+        {
+            archetype_column column;
+
+            column._size_of = _size_of;
+            column._align = _align;
+            column._move = _move;
+            column._destroy = _destroy;
+            column._write = _write;
+            column._read = _read;
+            return column;
+        }
+        /**
+         * @brief Check if the column was created for a component type
+         *
+         * @return true if it can store components
+         */
+        bool valid() const
+        {
+            return _move != nullptr;
+        }
+        /**
+         * @brief Get the number of components
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const
+        {
+            return _size;
+        }
+        /**
+         * @brief Get the contiguous storage of the components
+         *
+         * @return void*
+         */
+        void *data() const
+        {
+            return _data;
+        }
+        /**
+         * @brief Get the number of components the allocated storage can hold
+         *
+         * @return std::size_t
+         */
+        std::size_t capacity() const
+        {
+            return _capacity;
+        }
+        /**
+         * @brief Get the number of bytes allocated
+         *
+         * @return std::size_t
+         */
+        std::size_t memory_usage() const
+        {
+            return _capacity * _size_of;
+        }
+        /**
+         * @brief Get the number of times the storage was reallocated since the last reset
+         *
+         * @return std::size_t
+         */
+        std::size_t resize_count() const
+        {
+            return _resizes;
+        }
+        /**
+         * @brief Reset the count of resize_count to 0
+         *
+         */
+        void reset_resize_count()
+        {
+            _resizes = 0;
+        }
+        /**
+         * @brief Get the address of the component of a row
+         *
+         * @param row
+         * @return void*
+         */
+        void *at(std::size_t row) const
+        {
+            return _data + row * _size_of;
+        }
+        /**
+         * @brief Make room for components without reallocating
+         *
+         * @param capacity number of components
+         */
+        void reserve(std::size_t capacity)
+        {
+            if (capacity <= _capacity)
+                return;
+            std::byte *data = static_cast<std::byte *>(::operator new(capacity * _size_of, std::align_val_t(_align)));
+
+            for (std::size_t i = 0; i < _size; i++) {
+                _move(data + i * _size_of, at(i));
+                _destroy(at(i));
+            }
+            if (_data)
+                ::operator delete(_data, std::align_val_t(_align));
+            _data = data;
+            _capacity = capacity;
+            _resizes++;
+        }
+        /**
+         * @brief Add an uninitialized row at the end, the caller must construct the component in it
+         *
+         * @return void* address of the new row
+         */
+        void *push_uninitialized()
+        {
+            if (_size == _capacity)
+                reserve(_capacity ? _capacity * 2 : 16);
+            return at(_size++);
+        }
+        /**
+         * @brief Move the component of a row of another column of the same type at the end of this one
+         *
+         * @param from column to move from
+         * @param row of the component to move
+         */
+        void push_from(archetype_column &from, std::size_t row)
+        {
+            _move(push_uninitialized(), from.at(row));
+        }
+        /**
+         * @brief Destroy the component of a row and move the last component in its place
+         *
+         * @param row to remove
+         */
+        void swap_remove(std::size_t row)
+        {
+            std::size_t last = _size - 1;
+
+            _destroy(at(row));
+            if (row != last) {
+                _move(at(row), at(last));
+                _destroy(at(last));
+            }
+            _size--;
+        }
+
+        /**
+         * @brief Write the components of the column, in bulk if they are trivially copyable
+         *
+         * @param writer to write to
+         */
+        void snapshot(binary_writer &writer) const
+        {
+            _write(writer, *this);
+        }
+        /**
+         * @brief Append components written by snapshot to the column
+         *
+         * @param reader to read from
+         * @param count number of components to read
+         */
+        void restore(binary_reader &reader, std::size_t count)
+        {
+            _read(reader, *this, count);
+        }
+
+    private:
+        void release()
+        {
+            for (std::size_t i = 0; i < _size; i++)
+                _destroy(at(i));
+            if (_data)
+                ::operator delete(_data, std::align_val_t(_align));
+            _data = nullptr;
+            _size = 0;
+            _capacity = 0;
+        }
+
+    private:
+        std::byte *_data = nullptr;
+        std::size_t _size = 0;
+        std::size_t _capacity = 0;
+        std::size_t _resizes = 0;
+        std::size_t _size_of = 0;
+        std::size_t _align = 1;
+        void (*_move)(void *, void *) = nullptr;
+        void (*_destroy)(void *) = nullptr;
+        void (*_write)(binary_writer &, archetype_column const &) = nullptr;
+        void (*_read)(binary_reader &, archetype_column &, std::size_t) = nullptr;
+    };
+
+    /**
+     * @brief Table of the entities sharing the same set of components, each component type is a column and each entity a row
+     *
+     */
+    class archetype_table {
+    public:
+        using index_type = std::uint32_t; /**< entity of a row, an entity index fits in 32 bits */
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1); /**< column or table index that does not exist */
+
+        /**
+         * @brief Construct a new archetype table object
+         *
+         * @param sig components of the entities of the table
+         * @param columns one empty column per component of the signature, indexed by component id
+         */
+        archetype_table(signature const &sig, std::vector<archetype_column> const &columns) : _signature(sig)
+        {
+            _column_of.fill(npos);
+            _add_edges.fill(npos);
+            _remove_edges.fill(npos);
+            for (std::size_t id = 0; id < max_components; id++) {
+                if (sig.test(id)) {
+                    _column_of[id] = _columns.size();
+                    _ids.push_back(id);
+                    _columns.push_back(columns[id].empty_copy());
+                }
+            }
+        }
+
+        /**
+         * @brief Get the components of the entities of the table
+         *
+         * @return signature const&
+         */
+        signature const &get_signature() const
+        {
+            return _signature;
+        }
+        /**
+         * @brief Get the number of entities in the table
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const
+        {
+            return _entities.size();
+        }
+        /**
+         * @brief Get the entity of each row
+         *
+         * @return std::vector<index_type> const&
+         */
+        std::vector<index_type> const &entities() const
+        {
+            return _entities;
+        }
+        /**
+         * @brief Get the contiguous components of a type, nullptr if the table does not have them
+         *
+         * @tparam Component
+         * @return Component*
+         */
+        template <class Component> Component *column() const
+        {
+            std::size_t idx = _column_of[component_id<Component>()];
+
+            return idx == npos ? nullptr : static_cast<Component *>(_columns[idx].data());
+        }
+        /**
+         * @brief Get the column of a component id, nullptr if the table does not have it
+         *
+         * @param id of the component
+         * @return archetype_column const*
+         */
+        archetype_column const *find_column(std::size_t id) const
+        {
+            return _column_of[id] == npos ? nullptr : &_columns[_column_of[id]];
+        }
+
+    private:
+        friend class archetype_storage;
+
+        signature _signature;
+        std::vector<std::size_t> _ids;
+        std::vector<archetype_column> _columns;
+        std::vector<index_type> _entities;
+        std::array<std::size_t, max_components> _column_of;
+        std::array<std::size_t, max_components> _add_edges;
+        std::array<std::size_t, max_components> _remove_edges;
+    };
+
+    /**
+     * @brief Archetype storage, the entities with the same set of components share a table of contiguous columns.
+     * Iterating over some components walks the matching tables linearly, but adding or removing a component
+     * moves the entity and all its components to another table.
+     * Select it for a component with the component_storage trait:
+     * @code
+     * template <> struct ecs::component_storage<position> { using type = ecs::archetype_storage; };
+     * @endcode
+     *
+     */
+    class archetype_storage {
+        struct location {
+            std::size_t table = archetype_table::npos;
+            std::size_t row = 0;
+        };
+    public:
+        static constexpr std::size_t npos = archetype_table::npos; /**< table index of an entity without components */
+
+        archetype_storage() = default;
+        archetype_storage(archetype_storage const &) = delete;
+        archetype_storage &operator=(archetype_storage const &) = delete;
+
+        /**
+         * @brief Declare a component type stored in the archetypes, so tables using it can be created before any insertion
+         *
+         * @tparam Component
+         */
+        template <class Component> void register_component()
+        {
+            std::size_t id = component_id<Component>();
+
+            if (id >= _prototypes.size())
+                _prototypes.resize(id + 1);
+            if (!_prototypes[id].valid())
+                _prototypes[id] = archetype_column::make<Component>();
+        }
+        /**
+         * @brief Add a component to an entity, or replace it if the entity already has one. The entity moves to the table of its new set of components.
+         *
+         * @tparam Value
+         * @param pos entity to insert to
+         * @param component component to insert
+         * @return the component inserted
+         */
+        template <class Value> std::decay_t<Value> &insert_at(std::size_t pos, Value &&component)
+        {
+            using Component = std::decay_t<Value>;
+            std::size_t id = component_id<Component>();
+
+            register_component<Component>();
+            if (pos > static_cast<archetype_table::index_type>(-1))
+                throw std::out_of_range("Index out of range");
+            if (pos >= _locations.size())
+                _locations.resize(pos + 1);
+
+            location loc = _locations[pos];
+
+            if (loc.table != npos && _tables[loc.table]->_signature.test(id)) {
+                Component &current = _tables[loc.table]->column<Component>()[loc.row];
+
+                current = std::forward<Value>(component);
+                return current;
+            }
+
+            std::size_t target;
+
+            if (loc.table == npos) {
+                signature sig;
+
+                sig.set(id);
+                target = find_table(sig);
+            } else {
+                target = edge(loc.table, id, true);
+            }
+            archetype_table &table = *_tables[target];
+            std::size_t row = move_entity(pos, target);
+
+            new (table._columns[table._column_of[id]].push_uninitialized()) Component(std::forward<Value>(component));
+            return table.column<Component>()[row];
+        }
+        /**
+         * @brief Make room for entities up to a given index
+         *
+         * @param size number of entities covered
+         * @param count number of components about to be inserted, unused as the target tables are not known yet
+         */
+        void reserve(std::size_t size, std::size_t count = 0)
+        {
+            (void)count;
+            if (size > _locations.size())
+                _locations.resize(size);
+        }
+        /**
+         * @brief Remove a component from an entity. The entity moves to the table of its new set of components. If it does not have the component, nothing will happen.
+         *
+         * @tparam Component
+         * @param pos entity to remove the component from
+         */
+        template <class Component> void erase(std::size_t pos)
+        {
+            std::size_t id = component_id<Component>();
+
+            if (pos >= _locations.size() || _locations[pos].table == npos || !_tables[_locations[pos].table]->_signature.test(id))
+                return;
+
+            signature sig = _tables[_locations[pos].table]->_signature;
+
+            sig.reset(id);
+            if (sig.none())
+                destroy(pos);
+            else
+                move_entity(pos, edge(_locations[pos].table, id, false));
+        }
+        /**
+         * @brief Remove all the components of an entity
+         *
+         * @param pos entity
+         */
+        void destroy(std::size_t pos)
+        {
+            if (pos >= _locations.size() || _locations[pos].table == npos)
+                return;
+            remove_row(*_tables[_locations[pos].table], _locations[pos].row);
+            _locations[pos] = location();
+        }
+        /**
+         * @brief Check if an entity has a component
+         *
+         * @tparam Component
+         * @param pos entity to check
+         * @return true if it has the component
+         */
+        template <class Component> bool contains(std::size_t pos) const
+        {
+            return pos < _locations.size() && _locations[pos].table != npos
+                && _tables[_locations[pos].table]->_signature.test(component_id<Component>());
+        }
+        /**
+         * @brief Access the component of an entity. Can throw a std::out_of_range exception if the entity does not have it.
+         *
+         * @tparam Component
+         * @param pos entity
+         * @return Component&
+         */
+        template <class Component> Component &get(std::size_t pos)
+        {
+            if (!contains<Component>(pos))
+                throw std::out_of_range("Entity does not have the component");
+            return _tables[_locations[pos].table]->template column<Component>()[_locations[pos].row];
+        }
+        /**
+         * @brief Access the component of an entity. Can throw a std::out_of_range exception if the entity does not have it. (const)
+         *
+         * @tparam Component
+         * @param pos entity
+         * @return Component const&
+         */
+        template <class Component> Component const &get(std::size_t pos) const
+        {
+            if (!contains<Component>(pos))
+                throw std::out_of_range("Entity does not have the component");
+            return _tables[_locations[pos].table]->template column<Component>()[_locations[pos].row];
+        }
+        /**
+         * @brief Get all the tables
+         *
+         * @return std::vector<std::unique_ptr<archetype_table>> const&
+         */
+        std::vector<std::unique_ptr<archetype_table>> const &tables() const
+        {
+            return _tables;
+        }
+        /**
+         * @brief Reset the resize_count of the columns of all the tables to 0
+         *
+         */
+        void reset_resize_count()
+        {
+            for (auto &table : _tables) {
+                for (auto &column : table->_columns)
+                    column.reset_resize_count();
+            }
+        }
+        /**
+         * @brief Call a function on every entity having some components, walking each matching table linearly.
+         * The function receives the entity and its components, a const component is given as a const reference.
+         * Components must not be added or removed during the iteration.
+         * @code
+         * reg.archetypes().each<position, const velocity>([](std::size_t id, position &pos, velocity const &vel) {
+         *     pos.x += vel.x;
+         * });
+         * @endcode
+         *
+         * @tparam Components
+         * @tparam Function
+         * @param f function to call
+         */
+        template <class... Components, typename Function> void each(Function &&f)
+        {
+            signature required;
+
+            (required.set(component_id<Components>()), ...);
+            for (auto const &table : _tables) {
+                if ((table->_signature & required) != required || table->size() == 0)
+                    continue;
+                std::tuple<Components *...> columns(table->template column<std::remove_const_t<Components>>()...);
+                archetype_table::index_type const *entities = table->_entities.data();
+
+                for (std::size_t row = 0; row < table->size(); row++)
+                    f(entities[row], std::get<Components *>(columns)[row]...);
+            }
+        }
+
+        /**
+         * @brief Write all the tables
+         *
+         * @param writer to write to
+         */
+        void snapshot(binary_writer &writer) const
+        {
+            std::size_t count = std::count_if(_tables.begin(), _tables.end(), [](auto const &table) { return table->size() != 0; });
+
+            writer.write_size(_locations.size());
+            writer.write_size(count);
+            for (auto const &table : _tables) {
+                if (table->size() == 0)
+                    continue;
+                writer.write_bits(table->_signature);
+                writer.write_size(table->size());
+                writer.write_uints<std::uint32_t>(table->_entities.data(), table->size());
+                for (auto const &column : table->_columns)
+                    column.snapshot(writer);
+            }
+        }
+        /**
+         * @brief Replace all the tables by the ones written by snapshot. The component types must have been registered.
+         *
+         * @param reader to read from
+         * @param ids id in this registry of each component id of the writer, see detail::read_signature
+         */
+        void restore(binary_reader &reader, std::vector<std::size_t> const &ids)
+        {
+            std::size_t locations = reader.read_size();
+            std::size_t count = reader.read_size();
+            std::vector<std::size_t> order;
+
+            for (auto &table : _tables) {
+                for (auto &column : table->_columns)
+                    column = column.empty_copy();
+                table->_entities.clear();
+            }
+            _locations.assign(locations, location());
+            for (std::size_t i = 0; i < count; i++) {
+                signature sig = detail::read_signature(reader, ids, order);
+
+                for (std::size_t id : order) {
+                    if (id >= _prototypes.size() || !_prototypes[id].valid())
+                        throw std::runtime_error("Archetype snapshot uses an unregistered component");
+                }
+                archetype_table &table = *_tables[find_table(sig)];
+                std::size_t size = reader.read_size();
+
+                table._entities.resize(size);
+                reader.read_uints<std::uint32_t>(table._entities.data(), size);
+                // the columns were written in the order of the ids of the writer
+                for (std::size_t id : order)
+                    table._columns[table._column_of[id]].restore(reader, size);
+                for (std::size_t row = 0; row < size; row++) {
+                    if (table._entities[row] >= locations)
+                        throw std::runtime_error("Invalid archetype snapshot");
+                    _locations[table._entities[row]] = {find_table(sig), row};
+                }
+            }
+        }
+
+    private:
+        std::size_t find_table(signature const &sig)
+        {
+            auto it = _table_index.find(sig);
+
+            if (it != _table_index.end())
+                return it->second;
+            _tables.push_back(std::make_unique<archetype_table>(sig, _prototypes));
+            _table_index[sig] = _tables.size() - 1;
+            return _tables.size() - 1;
+        }
+
+        std::size_t edge(std::size_t from, std::size_t id, bool add)
+        {
+            std::size_t cached = add ? _tables[from]->_add_edges[id] : _tables[from]->_remove_edges[id];
+
+            if (cached != npos)
+                return cached;
+
+            signature sig = _tables[from]->_signature;
+
+            if (add)
+                sig.set(id);
+            else
+                sig.reset(id);
+            std::size_t to = find_table(sig);
+
+            (add ? _tables[from]->_add_edges[id] : _tables[from]->_remove_edges[id]) = to;
+            (add ? _tables[to]->_remove_edges[id] : _tables[to]->_add_edges[id]) = from;
+            return to;
+        }
+
+        std::size_t move_entity(std::size_t pos, std::size_t target)
+        {
+            archetype_table &to = *_tables[target];
+            location loc = _locations[pos];
+            std::size_t row = to._entities.size();
+
+            if (loc.table != npos) {
+                archetype_table &from = *_tables[loc.table];
+
+                for (std::size_t i = 0; i < from._ids.size(); i++) {
+                    std::size_t column = to._column_of[from._ids[i]];
+
+                    if (column != npos)
+                        to._columns[column].push_from(from._columns[i], loc.row);
+                }
+                remove_row(from, loc.row);
+            }
+            to._entities.push_back(static_cast<archetype_table::index_type>(pos));
+            _locations[pos] = {target, row};
+            return row;
+        }
+
+        void remove_row(archetype_table &table, std::size_t row)
+        {
+            for (auto &column : table._columns)
+                column.swap_remove(row);
+            table._entities[row] = table._entities.back();
+            table._entities.pop_back();
+            if (row < table._entities.size())
+                _locations[table._entities[row]].row = row;
+        }
+
+    private:
+        std::vector<std::unique_ptr<archetype_table>> _tables;
+        std::unordered_map<signature, std::size_t> _table_index;
+        std::vector<location> _locations;
+        std::vector<archetype_column> _prototypes;
+    };
+}
+
+#endif /* !ARCHETYPE_HPP_ */
@@ -0,0 +1,196 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Change_tracking
+*/
+
+#ifndef CHANGE_TRACKING_HPP_
+#define CHANGE_TRACKING_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace ecs {
+    /**
+     * @brief Tick of the registry, incremented by each run_systems. Tracked changes are stamped with it.
+     *
+     */
+    using tick_t = std::uint32_t;
+
+    /**
+     * @brief Enable change tracking for a component. Its container then stamps each component with the tick it was added
+     * and the tick it was last accessed mutably, and logs the removals. Specialize it to enable it:
+     * @code
+     * template <> struct ecs::track_changes<position> : std::true_type {};
+     * @endcode
+     *
+     * @tparam Component
+     */
+    template <class Component> struct track_changes : std::false_type {};
+
+    /**
+     * @brief Check if the changes of a component are tracked
+     *
+     * @tparam Component
+     */
+    template <class Component> inline constexpr bool track_changes_v = track_changes<Component>::value;
+
+    /**
+     * @brief Log of the indexes of the changed components in tick order, kept by the tracked containers so the changes
+     * after a tick are found without visiting every component. A component is logged the first time it changes in a tick.
+     * Several threads can record different indexes at the same time (par_for_each) in the room made by compact.
+     * When the room is exhausted the log is marked incomplete instead of growing, and the container visits its components
+     * until the next compact.
+     *
+     */
+    class change_log {
+    public:
+        struct record {
+            std::size_t index;
+            tick_t tick;
+        };
+
+        change_log() = default;
+        change_log(change_log const &from)
+            : _records(from._records), _size(from._size.load()), _start(from._start), _overflow(from._overflow.load())
+        {
+        }
+        change_log(change_log &&from) noexcept
+            : _records(std::move(from._records)), _size(from._size.load()), _start(from._start), _overflow(from._overflow.load())
+        {
+            from._size = 0;
+        }
+        ~change_log() = default;
+        change_log &operator=(change_log const &from)
+        {
+            if (this != &from) {
+                _records = from._records;
+                _size = from._size.load();
+                _start = from._start;
+                _overflow = from._overflow.load();
+            }
+            return *this;
+        }
+        change_log &operator=(change_log &&from) noexcept
+        {
+            _records = std::move(from._records);
+            _size = from._size.load();
+            _start = from._start;
+            _overflow = from._overflow.load();
+            from._size = 0;
+            return *this;
+        }
+
+        /**
+         * @brief Log a change in the room made by compact, can be called from several threads for different indexes
+         *
+         * @param index of the component
+         * @param tick of the change
+         */
+        void record_change(std::size_t index, tick_t tick)
+        {
+            std::size_t pos = _size.fetch_add(1, std::memory_order_relaxed);
+
+            if (pos < _records.size())
+                _records[pos] = record{index, tick};
+            else
+                _overflow.store(true, std::memory_order_relaxed);
+        }
+        /**
+         * @brief Log a change, growing the log if needed. Only for a single thread, used on insertion.
+         *
+         * @param index of the component
+         * @param tick of the change
+         */
+        void push(std::size_t index, tick_t tick)
+        {
+            if (_overflow)
+                return;
+            if (_size >= _records.size())
+                _records.resize(std::max<std::size_t>(64, _records.size() * 2));
+            record_change(index, tick);
+        }
+        /**
+         * @brief Check if the log holds every change made after a tick
+         *
+         * @param since tick
+         * @return true if the changes can be read from the log
+         */
+        bool covers(tick_t since) const
+        {
+            return !_overflow && since >= _start;
+        }
+        /**
+         * @brief Call a function on the records of the changes made after a tick. An index can appear several times,
+         * the container keeps the record matching the last change of its component.
+         *
+         * @tparam Function void(std::size_t index, tick_t tick)
+         * @param since tick
+         * @param f function to call
+         */
+        template <class Function> void for_each_since(tick_t since, Function &&f) const
+        {
+            auto end = _records.begin() + std::min(_size.load(), _records.size());
+            auto first = std::upper_bound(_records.begin(), end, since, [](tick_t t, record const &r) { return t < r.tick; });
+
+            for (auto it = first; it != end; ++it)
+                f(it->index, it->tick);
+        }
+        /**
+         * @brief Drop the records of the components changed again or removed since, and make room for the changes of the next tick.
+         * Called when the tick changes, from a single thread.
+         *
+         * @tparam Keep bool(std::size_t index, tick_t tick), true if the record is the last change of a component still stored
+         * @param tick ending, the last tick of the records
+         * @param room number of components that can change during the next tick
+         * @param keep filter of the records
+         */
+        template <class Keep> void compact(tick_t tick, std::size_t room, Keep &&keep)
+        {
+            std::size_t size = _size;
+
+            if (_overflow) {
+                reset(tick);
+                size = 0;
+            } else if (size > 2 * room + 64) {
+                size = std::remove_if(_records.begin(), _records.begin() + size, [&keep](record const &r) { return !keep(r.index, r.tick); }) - _records.begin();
+                _size = size;
+            }
+            if (_records.size() < size + room + 64)
+                _records.resize(size + room + 64);
+        }
+        /**
+         * @brief Forget all the records, the changes made up to a tick are not logged anymore
+         *
+         * @param start tick from which the log is complete again
+         */
+        void reset(tick_t start)
+        {
+            _size = 0;
+            _start = start;
+            _overflow = false;
+        }
+        /**
+         * @brief Get the number of bytes allocated
+         *
+         * @return std::size_t
+         */
+        std::size_t memory_usage() const
+        {
+            return _records.capacity() * sizeof(record);
+        }
+
+    private:
+        std::vector<record> _records; /**< sized to the room of the log, the first _size are used */
+        std::atomic<std::size_t> _size{0};
+        tick_t _start = 0; /**< the log holds every change made after this tick */
+        std::atomic<bool> _overflow{false};
+    };
+}
+
+#endif /* !CHANGE_TRACKING_HPP_ */
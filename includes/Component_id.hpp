@@ -0,0 +1,80 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Component_id
+*/
+
+#ifndef COMPONENT_ID_HPP_
+#define COMPONENT_ID_HPP_
+
+#include <atomic>
+#include <bitset>
+#include <cstddef>
+#include <type_traits>
+
+#ifndef ECS_MAX_COMPONENTS
+#define ECS_MAX_COMPONENTS 64
+#endif
+
+namespace ecs {
+    /**
+     * @brief Maximum number of component types, the size of a signature. Define ECS_MAX_COMPONENTS to change it.
+     *
+     */
+    inline constexpr std::size_t max_components = ECS_MAX_COMPONENTS;
+
+    /**
+     * @brief Set of the ids of the components an entity has
+     *
+     */
+    using signature = std::bitset<max_components>;
+
+    namespace detail {
+        /**
+         * @brief Get the counter of the component ids. There is one per process only if the modules resolve this function
+         * to the program: the registry compares its address to detect a module with its own ids.
+         *
+         * @return std::atomic<std::size_t>&
+         */
+        inline std::atomic<std::size_t> &component_id_counter()
+        {
+            static std::atomic<std::size_t> counter{0};
+            return counter;
+        }
+
+        /**
+         * @brief Get the next free component id, shared by the whole process
+         *
+         * @return std::size_t
+         */
+        inline std::size_t next_component_id()
+        {
+            return component_id_counter()++;
+        }
+
+        template <class Component> struct component_id_holder {
+            static std::size_t get()
+            {
+                static const std::size_t id = next_component_id();
+                return id;
+            }
+        };
+    }
+
+    /**
+     * @brief Get the id of a component type. Ids are dense and given in order of first use,
+     * so they can index a flat array. A module must resolve this function to the same symbols
+     * as the program loading it: the program has to export its symbols (ENABLE_EXPORTS, set on the executables
+     * linking the engine target, or -rdynamic), otherwise the registry refuses the components registered by the module.
+     *
+     * @tparam Component
+     * @return std::size_t
+     */
+    template <class Component> std::size_t component_id()
+    {
+        return detail::component_id_holder<std::remove_cv_t<Component>>::get();
+    }
+}
+
+#endif /* !COMPONENT_ID_HPP_ */
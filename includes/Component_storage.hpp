@@ -0,0 +1,41 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Component_storage
+*/
+
+#ifndef COMPONENT_STORAGE_HPP_
+#define COMPONENT_STORAGE_HPP_
+
+#include "Sparse_array.hpp"
+#include "Packed_array.hpp"
+#include "Soa_array.hpp"
+#include "Archetype.hpp"
+
+namespace ecs {
+    /**
+     * @brief Select the container used by the registry to store a component.
+     * Components are stored in a sparse_array by default, specialize this trait to change it:
+     * @code
+     * template <> struct ecs::component_storage<hitbox> { using type = ecs::packed_array<hitbox>; };
+     * @endcode
+     * Aggregate components can use a soa_array to store each of their fields in its own column.
+     * Using archetype_storage puts the component in the archetype tables shared by the registry,
+     * get_components then returns this shared storage.
+     *
+     * @tparam Component
+     */
+    template <class Component> struct component_storage {
+        using type = sparse_array<Component>;
+    };
+
+    /**
+     * @brief Container used by the registry to store a component
+     *
+     * @tparam Component
+     */
+    template <class Component> using storage_t = typename component_storage<Component>::type;
+}
+
+#endif /* !COMPONENT_STORAGE_HPP_ */
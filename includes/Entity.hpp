@@ -8,39 +8,102 @@
 #ifndef ENTITY_HPP_
 #define ENTITY_HPP_
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#ifndef ECS_ENTITY_INDEX_BITS
+#define ECS_ENTITY_INDEX_BITS 22
+#endif
+
 namespace ecs {
     /**
-     * @brief Entity class that represent an entity thanks to an id
-     * 
+     * @brief Entity class that represent an entity thanks to a 32-bit handle: an index, shared by the entities reusing
+     * the same id, and a generation, incremented each time the id is killed. A handle kept after the death of its
+     * entity keeps the old generation, so registry::alive detects it.
+     * The low ECS_ENTITY_INDEX_BITS bits are the index (22 by default, about 4 million entities), the others the generation.
+     * The generation wraps to 0 after generation_mask + 1 deaths of the same index (1024 by default): a handle kept that
+     * long matches the entity using the index again. Lower ECS_ENTITY_INDEX_BITS to keep more generations.
+     *
      */
     class entity {
         friend class registry;
+
+    public:
+        using handle_type = std::uint32_t;
+
+        static constexpr unsigned index_bits = ECS_ENTITY_INDEX_BITS; /**< bits of the handle holding the index */
+        static constexpr unsigned generation_bits = 32 - index_bits; /**< bits of the handle holding the generation */
+        static constexpr handle_type index_mask = (handle_type(1) << index_bits) - 1; /**< highest index */
+        static constexpr handle_type generation_mask = handle_type(-1) >> index_bits; /**< highest generation, then it wraps to 0 */
+
+        static_assert(index_bits > 0 && index_bits < 32, "ECS_ENTITY_INDEX_BITS must leave bits for the index and the generation");
+
         /**
-         * @brief Construct a new entity object with an id
-         * 
-         * @param id
+         * @brief inplicit conversion operator to size_t, used to index the containers
+         *
+         * @return index of the entity
          */
-        explicit entity(size_t id)
-            : _id(id)
+        operator size_t() const
         {
+            return _handle & index_mask;
         }
-
-    public:
         /**
-         * @brief inplicit conversion operator to size_t
-         * 
-         * @return id of the entity
+         * @brief Get the index of the entity
+         *
+         * @return std::size_t
          */
-        operator size_t() const
+        std::size_t index() const
         {
-            return _id;
+            return _handle & index_mask;
+        }
+        /**
+         * @brief Get the generation of the entity
+         *
+         * @return handle_type
+         */
+        handle_type generation() const
+        {
+            return _handle >> index_bits;
+        }
+        /**
+         * @brief Get the whole handle, to send the entity over the network for example
+         *
+         * @return handle_type
+         */
+        handle_type handle() const
+        {
+            return _handle;
+        }
+        /**
+         * @brief Compare the index and the generation of two entities
+         *
+         * @param other entity
+         * @return true if they are the same handle
+         */
+        bool operator==(entity const &other) const
+        {
+            return _handle == other._handle;
+        }
+        bool operator!=(entity const &other) const
+        {
+            return _handle != other._handle;
         }
 
     private:
-        size_t _id; /**< id of the entity */
+        /**
+         * @brief Construct a new entity object with an index and a generation
+         *
+         * @param id index of the entity
+         * @param generation of the index
+         */
+        explicit entity(size_t id, handle_type generation = 0)
+            : _handle(static_cast<handle_type>(id & index_mask) | ((generation & generation_mask) << index_bits))
+        {
+        }
+
+        handle_type _handle; /**< index and generation of the entity */
     };
 }
 
-#endif /* !ENTITY_HPP_ */
\ No newline at end of file
+#endif /* !ENTITY_HPP_ */
@@ -0,0 +1,290 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Entity_allocator
+*/
+
+#ifndef ENTITY_ALLOCATOR_HPP_
+#define ENTITY_ALLOCATOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ecs {
+    /**
+     * @brief Lock-free source of entity ids: the freed ids are kept in a lock-free stack and reused first, the new ids
+     * come from an atomic counter. Each id has a generation, incremented when it is released. allocate, release,
+     * generation and is_free can be called from any thread; free_ids and reset need no other call running at the same time.
+     *
+     */
+    class entity_allocator {
+    public:
+        static constexpr std::size_t max_recycled = std::size_t(1) << 26; /**< freed ids above this are not reused */
+
+        entity_allocator() = default;
+        entity_allocator(entity_allocator const &) = delete;
+        entity_allocator &operator=(entity_allocator const &) = delete;
+        ~entity_allocator()
+        {
+            page_slot *table = _table.load();
+
+            if (!table)
+                return;
+            for (std::size_t i = 0; i < page_count; i++)
+                delete[] table[i].load();
+            delete[] table;
+        }
+
+        /**
+         * @brief Get an id, a freed one if there is any
+         *
+         * @return std::size_t
+         */
+        std::size_t allocate()
+        {
+            std::size_t id;
+
+            return reuse(id) ? id : allocate_block(1);
+        }
+        /**
+         * @brief Take the last freed id
+         *
+         * @param id set to the id taken
+         * @return true if there was a freed id
+         */
+        bool reuse(std::size_t &id)
+        {
+            std::uint64_t head = _head.load(std::memory_order_acquire);
+
+            while (index_of(head) != nil) {
+                std::uint32_t top = index_of(head);
+                std::uint32_t next = slot_of(top).link.load(std::memory_order_relaxed) & ~in_stack;
+
+                // the tag changes on every update, so a top popped and pushed again in between makes the exchange fail
+                if (_head.compare_exchange_weak(head, pack(next, head), std::memory_order_acquire, std::memory_order_acquire)) {
+                    slot_of(top).link.fetch_and(~in_stack, std::memory_order_relaxed);
+                    _free_count.fetch_sub(1, std::memory_order_relaxed);
+                    id = top;
+                    return true;
+                }
+            }
+            return false;
+        }
+        /**
+         * @brief Get new ids following each other, never freed before
+         *
+         * @param count number of ids
+         * @return std::size_t the first id of the block
+         */
+        std::size_t allocate_block(std::size_t count)
+        {
+            return _next.fetch_add(count, std::memory_order_relaxed);
+        }
+        /**
+         * @brief Give back an id, reused by the next allocations, and increment its generation. Releasing an id already
+         * waiting to be reused does nothing.
+         *
+         * @param id freed
+         */
+        void release(std::size_t id)
+        {
+            if (id >= max_recycled)
+                return;
+            slot &s = slot_for_release(static_cast<std::uint32_t>(id));
+
+            // pushing an id twice would loop the stack
+            if (s.link.fetch_or(in_stack, std::memory_order_relaxed) & in_stack)
+                return;
+            s.generation.fetch_add(1, std::memory_order_release);
+            push(s, static_cast<std::uint32_t>(id));
+        }
+        /**
+         * @brief Get the generation of an id, the number of times it was released
+         *
+         * @param id
+         * @return std::uint32_t
+         */
+        std::uint32_t generation(std::size_t id) const
+        {
+            slot const *s = find_slot(id);
+
+            return s ? s->generation.load(std::memory_order_acquire) : 0;
+        }
+        /**
+         * @brief Check if an id is waiting to be reused
+         *
+         * @param id
+         * @return true if it was released and not allocated again
+         */
+        bool is_free(std::size_t id) const
+        {
+            slot const *s = find_slot(id);
+
+            return s && (s->link.load(std::memory_order_acquire) & in_stack);
+        }
+
+        /**
+         * @brief Get the number of ids given since the beginning, the highest id plus one
+         *
+         * @return std::size_t
+         */
+        std::size_t issued() const
+        {
+            return _next.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief Get the number of freed ids waiting to be reused
+         *
+         * @return std::size_t
+         */
+        std::size_t free_count() const
+        {
+            return _free_count.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief Get the freed ids, the next one reused last
+         *
+         * @return std::vector<std::size_t>
+         */
+        std::vector<std::size_t> free_ids() const
+        {
+            std::vector<std::size_t> ids;
+
+            for (std::uint32_t id = index_of(_head.load()); id != nil; id = slot_of(id).link.load() & ~in_stack)
+                ids.push_back(id);
+            std::reverse(ids.begin(), ids.end());
+            return ids;
+        }
+        /**
+         * @brief Get the generations of the ids given, as many as issued
+         *
+         * @return std::vector<std::uint32_t>
+         */
+        std::vector<std::uint32_t> generations() const
+        {
+            std::vector<std::uint32_t> result(issued());
+
+            for (std::size_t id = 0; id < result.size(); id++)
+                result[id] = generation(id);
+            return result;
+        }
+        /**
+         * @brief Replace the state of the allocator, as returned by issued, free_ids and generations
+         *
+         * @param issued number of ids given
+         * @param free freed ids, the last one reused first
+         * @param generations of the ids, the missing ones are 0
+         */
+        void reset(std::size_t issued, std::vector<std::size_t> const &free, std::vector<std::uint32_t> const &generations = {})
+        {
+            if (page_slot *table = _table.load()) {
+                for (std::size_t i = 0; i < page_count; i++) {
+                    if (slot *page = table[i].load()) {
+                        for (std::size_t j = 0; j < page_size; j++) {
+                            page[j].link.store(0);
+                            page[j].generation.store(0);
+                        }
+                    }
+                }
+            }
+            _head.store(pack(nil, 0));
+            _free_count.store(0);
+            _next.store(issued);
+            for (std::size_t id = 0; id < generations.size() && id < max_recycled; id++) {
+                if (generations[id])
+                    slot_for_release(static_cast<std::uint32_t>(id)).generation.store(generations[id]);
+            }
+            for (std::size_t id : free) {
+                if (id >= max_recycled)
+                    continue;
+                slot &s = slot_for_release(static_cast<std::uint32_t>(id));
+
+                if (!(s.link.fetch_or(in_stack) & in_stack))
+                    push(s, static_cast<std::uint32_t>(id));
+            }
+        }
+
+    private:
+        static constexpr std::uint32_t nil = 0x7FFFFFFF;
+        static constexpr std::uint32_t in_stack = 0x80000000; /**< flag of the links of the ids in the stack */
+        static constexpr std::size_t page_bits = 12;
+        static constexpr std::size_t page_size = std::size_t(1) << page_bits;
+        static constexpr std::size_t page_count = max_recycled / page_size;
+
+        struct slot {
+            std::atomic<std::uint32_t> link{0}; /**< next id of the stack, with the in_stack flag */
+            std::atomic<std::uint32_t> generation{0};
+        };
+        using page_slot = std::atomic<slot *>;
+
+        static std::uint32_t index_of(std::uint64_t head)
+        {
+            return static_cast<std::uint32_t>(head);
+        }
+        static std::uint64_t pack(std::uint32_t index, std::uint64_t previous)
+        {
+            return (((previous >> 32) + 1) << 32) | index;
+        }
+        // slot of an id that was pushed, so its page exists
+        slot &slot_of(std::uint32_t id) const
+        {
+            return _table.load(std::memory_order_acquire)[id >> page_bits].load(std::memory_order_acquire)[id & (page_size - 1)];
+        }
+        slot const *find_slot(std::size_t id) const
+        {
+            page_slot *table = _table.load(std::memory_order_acquire);
+
+            if (!table || id >= max_recycled)
+                return nullptr;
+            slot *page = table[id >> page_bits].load(std::memory_order_acquire);
+
+            return page ? &page[id & (page_size - 1)] : nullptr;
+        }
+        // the pages of slots are allocated by the first release of one of their ids and kept until the destruction
+        slot &slot_for_release(std::uint32_t id)
+        {
+            page_slot *table = _table.load(std::memory_order_acquire);
+
+            if (!table) {
+                page_slot *created = new page_slot[page_count]();
+
+                if (_table.compare_exchange_strong(table, created, std::memory_order_acq_rel))
+                    table = created;
+                else
+                    delete[] created;
+            }
+            page_slot &entry = table[id >> page_bits];
+            slot *page = entry.load(std::memory_order_acquire);
+
+            if (!page) {
+                slot *created = new slot[page_size]();
+
+                if (entry.compare_exchange_strong(page, created, std::memory_order_acq_rel))
+                    page = created;
+                else
+                    delete[] created;
+            }
+            return page[id & (page_size - 1)];
+        }
+        void push(slot &s, std::uint32_t id)
+        {
+            std::uint64_t head = _head.load(std::memory_order_relaxed);
+
+            _free_count.fetch_add(1, std::memory_order_relaxed);
+            do {
+                s.link.store(in_stack | index_of(head), std::memory_order_relaxed);
+            } while (!_head.compare_exchange_weak(head, pack(id, head), std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        std::atomic<std::uint64_t> _head{(std::uint64_t(0) << 32) | nil};
+        std::atomic<std::size_t> _next{0};
+        std::atomic<std::size_t> _free_count{0};
+        std::atomic<page_slot *> _table{nullptr};
+    };
+}
+
+#endif /* !ENTITY_ALLOCATOR_HPP_ */
@@ -0,0 +1,262 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Event_channel
+*/
+
+#ifndef EVENT_CHANNEL_HPP_
+#define EVENT_CHANNEL_HPP_
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "Entity.hpp"
+#include "Profiler.hpp"
+
+namespace ecs {
+    class registry;
+
+    /**
+     * @brief Base class of the event channels, used by the registry to store channels of any type
+     *
+     */
+    class event_channel_base {
+    public:
+        virtual ~event_channel_base() = default;
+        /**
+         * @brief Dispatch the queued events to the handlers
+         *
+         * @param reg registry given to the handlers
+         * @param entities given to the handlers
+         */
+        virtual void flush(registry &reg, std::vector<entity> &entities) = 0;
+#ifdef ECS_PROFILING
+        /**
+         * @brief Measure the handlers of the channel, called by the registry when the channel is created
+         *
+         * @param prof profiler recording the calls
+         * @param name of the event, the handlers are named after it
+         */
+        virtual void set_profiler(profiler &prof, std::string const &name) = 0;
+#endif
+        /**
+         * @brief Remove the handlers added by a module, used by the registry to unload or reload it
+         *
+         * @param owner id of the module
+         */
+        virtual void remove_handlers(std::size_t owner) = 0;
+        /**
+         * @brief Tag the next handlers with the module being loaded, called by the registry when the channel is created
+         *
+         * @param owner id of the module being loaded, 0 outside of a module entrypoint
+         */
+        void set_owner(std::size_t const &owner)
+        {
+            _owner = &owner;
+        }
+
+    protected:
+        std::size_t current_owner() const
+        {
+            return _owner ? *_owner : 0;
+        }
+
+    private:
+        std::size_t const *_owner = nullptr;
+    };
+
+    /**
+     * @brief Typed event channel. Resolve it once with registry::get_event, then trigger it without looking up its name.
+     * Events can be dispatched immediately with trigger, or queued with push and dispatched together by flush:
+     * batch handlers then receive all the events of the tick in one contiguous vector.
+     * The handlers receive the parameters by const reference, so a handler taking them by const reference does not copy them.
+     *
+     * @tparam Args parameters of the event, in addition to the registry and the entity vector
+     */
+    template <typename... Args> class event_channel : public event_channel_base {
+    public:
+        using event = std::tuple<Args...>;
+        using handler = std::function<void(registry &, std::vector<entity> &, Args const &...)>;
+        using batch_handler = std::function<void(registry &, std::vector<entity> &, std::vector<event> const &)>;
+
+        /**
+         * @brief Add a handler called for each event
+         *
+         * @param f handler
+         */
+        void subscribe(handler f)
+        {
+            _handlers.push_back(std::move(f));
+            _handler_owners.push_back(current_owner());
+#ifdef ECS_PROFILING
+            if (_profiler)
+                _zones.push_back(_profiler->add_zone(_name + " #" + std::to_string(_handlers.size() - 1), "event"));
+#endif
+        }
+        /**
+         * @brief Add a handler called once per flush with all the queued events
+         *
+         * @param f handler
+         */
+        void subscribe_batch(batch_handler f)
+        {
+            _batch_handlers.push_back(std::move(f));
+            _batch_owners.push_back(current_owner());
+#ifdef ECS_PROFILING
+            if (_profiler)
+                _batch_zones.push_back(_profiler->add_zone(_name + " batch #" + std::to_string(_batch_handlers.size() - 1), "event"));
+#endif
+        }
+        /**
+         * @brief Dispatch an event immediately to the handlers. Batch handlers receive it alone.
+         *
+         * @param reg registry given to the handlers
+         * @param entities given to the handlers
+         * @param args parameters of the event
+         */
+        void trigger(registry &reg, std::vector<entity> &entities, Args const &...args)
+        {
+            for (std::size_t i = 0; i < _handlers.size(); i++) {
+#ifdef ECS_PROFILING
+                profiler::clock::time_point start = profiler::clock::now();
+
+                _handlers[i](reg, entities, args...);
+                if (_profiler)
+                    _profiler->record(_zones[i], start, entities.size());
+#else
+                _handlers[i](reg, entities, args...);
+#endif
+            }
+            if (!_batch_handlers.empty()) {
+                std::vector<event> single{event(args...)};
+
+                call_batch_handlers(reg, entities, single);
+            }
+        }
+        /**
+         * @brief Queue an event until the next flush. Can be called from several threads.
+         *
+         * @param args parameters of the event
+         */
+        void push(Args... args)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            _queue.emplace_back(std::move(args)...);
+        }
+        /**
+         * @brief Get the number of queued events
+         *
+         * @return std::size_t
+         */
+        std::size_t pending() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            return _queue.size();
+        }
+        /**
+         * @brief Dispatch the queued events: each batch handler is called once with all of them, then each handler is called per event.
+         * Events pushed by the handlers or by other threads during the dispatch are kept for the next flush.
+         *
+         * @param reg registry given to the handlers
+         * @param entities given to the handlers
+         */
+        void flush(registry &reg, std::vector<entity> &entities) override
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+
+                if (_queue.empty())
+                    return;
+                std::swap(_queue, _dispatching);
+            }
+            call_batch_handlers(reg, entities, _dispatching);
+            for (std::size_t i = 0; i < _handlers.size(); i++) {
+                for (auto &e : _dispatching) {
+#ifdef ECS_PROFILING
+                    // one record per event, like trigger, so the calls of a handler count the events it received
+                    profiler::clock::time_point start = profiler::clock::now();
+
+                    std::apply([&](Args const &...args) { _handlers[i](reg, entities, args...); }, e);
+                    if (_profiler)
+                        _profiler->record(_zones[i], start, entities.size());
+#else
+                    std::apply([&](Args const &...args) { _handlers[i](reg, entities, args...); }, e);
+#endif
+                }
+            }
+            _dispatching.clear();
+        }
+        void remove_handlers(std::size_t owner) override
+        {
+            for (std::size_t i = _handlers.size(); i-- > 0;) {
+                if (_handler_owners[i] != owner)
+                    continue;
+                _handlers.erase(_handlers.begin() + i);
+                _handler_owners.erase(_handler_owners.begin() + i);
+#ifdef ECS_PROFILING
+                if (i < _zones.size())
+                    _zones.erase(_zones.begin() + i);
+#endif
+            }
+            for (std::size_t i = _batch_handlers.size(); i-- > 0;) {
+                if (_batch_owners[i] != owner)
+                    continue;
+                _batch_handlers.erase(_batch_handlers.begin() + i);
+                _batch_owners.erase(_batch_owners.begin() + i);
+#ifdef ECS_PROFILING
+                if (i < _batch_zones.size())
+                    _batch_zones.erase(_batch_zones.begin() + i);
+#endif
+            }
+        }
+#ifdef ECS_PROFILING
+        void set_profiler(profiler &prof, std::string const &name) override
+        {
+            _profiler = &prof;
+            _name = name;
+            for (std::size_t i = _zones.size(); i < _handlers.size(); i++)
+                _zones.push_back(prof.add_zone(_name + " #" + std::to_string(i), "event"));
+            for (std::size_t i = _batch_zones.size(); i < _batch_handlers.size(); i++)
+                _batch_zones.push_back(prof.add_zone(_name + " batch #" + std::to_string(i), "event"));
+        }
+#endif
+
+    private:
+        void call_batch_handlers(registry &reg, std::vector<entity> &entities, std::vector<event> const &events)
+        {
+            for (std::size_t i = 0; i < _batch_handlers.size(); i++) {
+#ifdef ECS_PROFILING
+                profiler::clock::time_point start = profiler::clock::now();
+
+                _batch_handlers[i](reg, entities, events);
+                if (_profiler)
+                    _profiler->record(_batch_zones[i], start, entities.size());
+#else
+                _batch_handlers[i](reg, entities, events);
+#endif
+            }
+        }
+
+    private:
+        std::vector<handler> _handlers;
+        std::vector<batch_handler> _batch_handlers;
+        std::vector<std::size_t> _handler_owners;
+        std::vector<std::size_t> _batch_owners;
+        std::vector<event> _queue;
+        std::vector<event> _dispatching;
+        mutable std::mutex _mutex;
+#ifdef ECS_PROFILING
+        profiler *_profiler = nullptr;
+        std::string _name;
+        std::vector<std::size_t> _zones;
+        std::vector<std::size_t> _batch_zones;
+#endif
+    };
+}
+
+#endif /* !EVENT_CHANNEL_HPP_ */
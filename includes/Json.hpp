@@ -0,0 +1,44 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Json
+*/
+
+#ifndef JSON_HPP_
+#define JSON_HPP_
+
+#include <cstdio>
+#include <string>
+
+namespace ecs {
+    namespace detail {
+        /**
+         * @brief Escape a string to write it between quotes in a JSON document, used by the profiler and the registry stats
+         *
+         * @param str to escape
+         * @return std::string
+         */
+        inline std::string json_escape(std::string const &str)
+        {
+            std::string escaped;
+
+            for (char c : str) {
+                if (c == '"' || c == '\\') {
+                    escaped += '\\';
+                    escaped += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char code[7];
+
+                    std::snprintf(code, sizeof(code), "\\u%04x", static_cast<unsigned>(c));
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+    }
+}
+
+#endif /* !JSON_HPP_ */
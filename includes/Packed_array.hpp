@@ -0,0 +1,760 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Packed_array
+*/
+
+#ifndef PACKED_ARRAY_HPP_
+#define PACKED_ARRAY_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+#include "Change_tracking.hpp"
+#include "Serialization.hpp"
+
+namespace ecs {
+    /**
+     * @brief Nullable reference to a component, returned by the packed_array accessors in place of an optional
+     *
+     * @tparam Component
+     */
+    template <typename Component> class component_ref {
+    public:
+        /**
+         * @brief Construct a new component ref object
+         *
+         * @param ptr component referenced, nullptr if the entity does not have it
+         */
+        explicit component_ref(Component *ptr = nullptr) : _ptr(ptr) {}
+
+        /**
+         * @brief Check if the reference points to a component
+         *
+         * @return true if the component is present
+         */
+        bool has_value() const
+        {
+            return _ptr != nullptr;
+        }
+        /**
+         * @brief Check if the reference points to a component
+         *
+         * @return true if the component is present
+         */
+        explicit operator bool() const
+        {
+            return has_value();
+        }
+        /**
+         * @brief Access the component. Throws a std::bad_optional_access if there is none.
+         *
+         * @return Component&
+         */
+        Component &value() const
+        {
+            if (!_ptr)
+                throw std::bad_optional_access();
+            return *_ptr;
+        }
+        /**
+         * @brief Access the component without checking it is present
+         *
+         * @return Component&
+         */
+        Component &operator*() const
+        {
+            return *_ptr;
+        }
+        /**
+         * @brief Access the component members without checking it is present
+         *
+         * @return Component*
+         */
+        Component *operator->() const
+        {
+            return _ptr;
+        }
+
+    private:
+        Component *_ptr;
+    };
+
+    /**
+     * @brief Packed array class, a sparse set storing the components contiguously.
+     * Components live in a dense array, a parallel array holds the entity owning each of them,
+     * and a sparse index maps an entity to its position in the dense array.
+     * Iterating only walks the live components, but erasing moves the last component in the hole,
+     * so references to components are not stable.
+     *
+     * @tparam Component
+     */
+    template <typename Component> class packed_array {
+    public:
+        using value_type = Component;
+        using reference_type = component_ref<Component>;
+        using const_reference_type = component_ref<Component const>;
+        using container_t = std::vector<Component>;
+        using size_type = typename container_t::size_type;
+        using iterator = typename container_t::iterator;
+        using const_iterator = typename container_t::const_iterator;
+
+        using index_type = std::uint32_t; /**< entities and positions in the dense array, an entity index fits in 32 bits */
+
+        static constexpr size_type npos = static_cast<size_type>(-1); /**< index returned when there is no component */
+        static constexpr index_type absent = static_cast<index_type>(-1); /**< sparse index value of an entity without component */
+
+    public:
+        /**
+         * @brief Construct a new packed array object
+         *
+         */
+        packed_array() = default;
+        /**
+         * @brief Copy construct a new packed array object
+         *
+         * @param from packed_array to copy
+         */
+        packed_array(packed_array const &from) = default;
+        /**
+         * @brief Move construct a new packed array object
+         *
+         * @param from packed_array to move
+         */
+        packed_array(packed_array &&from) noexcept = default;
+
+        /**
+         * @brief Destroy the packed array object
+         *
+         */
+        ~packed_array() = default;
+
+        /**
+         * @brief Copy assign a new packed array object
+         *
+         * @param from packed_array to copy
+         */
+        packed_array &operator=(packed_array const &from) = default;
+        /**
+         * @brief Move assign a new packed array object
+         *
+         * @param from packed_array to move
+         */
+        packed_array &operator=(packed_array &&from) noexcept = default;
+
+        /**
+         * @brief Overload of operator[] to access the component of an entity. Can throw a std::out_of_range exception.
+         *
+         * @param idx entity to access
+         * @return reference_type, empty if the entity does not have the component
+         */
+        reference_type operator[](size_t idx)
+        {
+            if (idx >= _sparse.size())
+                throw std::out_of_range("Index out of range");
+            if (_sparse[idx] == absent)
+                return reference_type(nullptr);
+            touch(_sparse[idx]);
+            return reference_type(&_dense[_sparse[idx]]);
+        }
+        /**
+         * @brief Overload of operator[] to access the component of an entity. Can throw a std::out_of_range exception. (const)
+         *
+         * @param idx entity to access
+         * @return const_reference_type, empty if the entity does not have the component
+         */
+        const_reference_type operator[](size_t idx) const
+        {
+            if (idx >= _sparse.size())
+                throw std::out_of_range("Index out of range");
+            return const_reference_type(_sparse[idx] == absent ? nullptr : &_dense[_sparse[idx]]);
+        }
+        /**
+         * @brief Get the begin of the live components. They can all be written through it, so they are all stamped as changed.
+         *
+         * @return iterator
+         */
+        iterator begin()
+        {
+            touch_all();
+            return _dense.begin();
+        }
+        /**
+         * @brief Get the begin of the live components (const)
+         *
+         * @return const_iterator
+         */
+        const_iterator begin() const
+        {
+            return _dense.begin();
+        }
+        /**
+         * @brief Get the begin of the live components (const)
+         *
+         * @return const_iterator
+         */
+        const_iterator cbegin() const
+        {
+            return _dense.cbegin();
+        }
+        /**
+         * @brief Get the end of the live components, they are all stamped as changed like by begin()
+         *
+         * @return iterator
+         */
+        iterator end()
+        {
+            touch_all();
+            return _dense.end();
+        }
+        /**
+         * @brief Get the end of the live components (const)
+         *
+         * @return const_iterator
+         */
+        const_iterator end() const
+        {
+            return _dense.end();
+        }
+        /**
+         * @brief Get the end of the live components (const)
+         *
+         * @return const_iterator
+         */
+        const_iterator cend() const
+        {
+            return _dense.cend();
+        }
+        /**
+         * @brief Get the number of indexes covered by the packed_array, like sparse_array::size()
+         *
+         * @return size_type
+         */
+        size_type size() const
+        {
+            return _sparse.size();
+        }
+        /**
+         * @brief Get the number of components stored
+         *
+         * @return size_type
+         */
+        size_type live_count() const
+        {
+            return _dense.size();
+        }
+        /**
+         * @brief Get the number of components the allocated storage can hold
+         *
+         * @return size_type
+         */
+        size_type capacity() const
+        {
+            return _dense.capacity();
+        }
+        /**
+         * @brief Get the number of bytes allocated: the components, their entities, the sparse index and the change ticks
+         *
+         * @return size_type
+         */
+        size_type memory_usage() const
+        {
+            return _dense.capacity() * sizeof(Component) + (_entities.capacity() + _sparse.capacity()) * sizeof(index_type)
+                + (_added.capacity() + _changed.capacity()) * sizeof(tick_t) + _removed.capacity() * sizeof(std::pair<size_type, tick_t>) + _log.memory_usage();
+        }
+        /**
+         * @brief Get the number of times the storage grew (the components or the sparse index reallocated) since the last reset
+         *
+         * @return size_type
+         */
+        size_type resize_count() const
+        {
+            return _resizes;
+        }
+        /**
+         * @brief Reset the count of resize_count to 0
+         *
+         */
+        void reset_resize_count()
+        {
+            _resizes = 0;
+        }
+        /**
+         * @brief Check if an entity has a component
+         *
+         * @param idx entity to check
+         * @return true if the entity has a component
+         */
+        bool contains(size_type idx) const
+        {
+            return idx < _sparse.size() && _sparse[idx] != absent;
+        }
+        /**
+         * @brief Access the component of an entity without checking it exists
+         *
+         * @param idx entity to access
+         * @return Component&
+         */
+        Component &get(size_type idx)
+        {
+            touch(_sparse[idx]);
+            return _dense[_sparse[idx]];
+        }
+        /**
+         * @brief Access the component of an entity without checking it exists (const)
+         *
+         * @param idx entity to access
+         * @return Component const&
+         */
+        Component const &get(size_type idx) const
+        {
+            return _dense[_sparse[idx]];
+        }
+        /**
+         * @brief Get the number of positions to walk when this array drives a zipper, only the live components are walked
+         *
+         * @return size_type
+         */
+        size_type scan_size() const
+        {
+            return _dense.size();
+        }
+        /**
+         * @brief Get the entity found at a position of the walk done by a zipper
+         *
+         * @param pos in the walk, lower than scan_size()
+         * @return size_type entity
+         */
+        size_type scan_index(size_type pos) const
+        {
+            return _entities[pos];
+        }
+        /**
+         * @brief Get the entities owning the components, in the same order as the components
+         *
+         * @return std::vector<index_type> const&
+         */
+        std::vector<index_type> const &entities() const
+        {
+            return _entities;
+        }
+        /**
+         * @brief Get the contiguous storage of the components. They can all be written through it, so they are all stamped as changed.
+         *
+         * @return Component*
+         */
+        Component *data()
+        {
+            touch_all();
+            return _dense.data();
+        }
+        /**
+         * @brief Get the contiguous storage of the components (const)
+         *
+         * @return Component const*
+         */
+        Component const *data() const
+        {
+            return _dense.data();
+        }
+        /**
+         * @brief Insert a component for an entity. If the entity already has one, it is replaced.
+         *
+         * @param pos entity to insert to
+         * @param component component to insert
+         * @return reference_type
+         */
+        reference_type insert_at(size_type pos, Component const &component)
+        {
+            return emplace(pos, component);
+        }
+        /**
+         * @brief Insert a component for an entity. Like the previous one, but move the component instead of copying it.
+         *
+         * @param pos entity to insert to
+         * @param component component to insert
+         * @return reference_type
+         */
+        reference_type insert_at(size_type pos, Component &&component)
+        {
+            return emplace(pos, std::move(component));
+        }
+        /**
+         * @brief Make room for components up to a given entity, so the next insertions do not reallocate
+         *
+         * @param size number of entities covered by the sparse index
+         * @param count number of components about to be inserted
+         */
+        void reserve(size_type size, size_type count = 0)
+        {
+            if (size > _sparse.capacity() || _dense.size() + count > _dense.capacity())
+                _resizes++;
+            if (size > _sparse.size())
+                _sparse.resize(size, absent);
+            _dense.reserve(_dense.size() + count);
+            _entities.reserve(_entities.size() + count);
+            if constexpr (track_changes_v<Component>) {
+                _added.reserve(_added.size() + count);
+                _changed.reserve(_changed.size() + count);
+            }
+        }
+        /**
+         * @brief Remove the component of an entity. The last component is moved in its place. If the entity has no component, nothing will happen.
+         *
+         * @tparam Params
+         * @param pos entity of the component to remove
+         */
+        template <class... Params> void erase(size_type pos)
+        {
+            if (pos >= _sparse.size() || _sparse[pos] == absent)
+                return;
+            size_type hole = _sparse[pos];
+            size_type last = _dense.size() - 1;
+
+            if (hole != last) {
+                _dense[hole] = std::move(_dense[last]);
+                _entities[hole] = _entities[last];
+                _sparse[_entities[hole]] = static_cast<index_type>(hole);
+                if constexpr (track_changes_v<Component>) {
+                    _added[hole] = _added[last];
+                    _changed[hole] = _changed[last];
+                }
+            }
+            _dense.pop_back();
+            _entities.pop_back();
+            _sparse[pos] = absent;
+            if constexpr (track_changes_v<Component>) {
+                _added.pop_back();
+                _changed.pop_back();
+                _removed.emplace_back(pos, _tick);
+            }
+        }
+        /**
+         * @brief Remove all the components. The removals are not logged, used to restore a snapshot.
+         *
+         */
+        void clear()
+        {
+            _dense.clear();
+            _entities.clear();
+            _sparse.clear();
+            _added.clear();
+            _changed.clear();
+            _log.reset(_tick);
+        }
+        /**
+         * @brief Get the entity owning a component of the packed_array. If the component is not in the packed_array, -1 will be returned.
+         *
+         * @param value component to get the index of
+         * @return size_type
+         */
+        size_type get_index(Component const &value) const
+        {
+            auto addrval = std::addressof(value);
+
+            if (_dense.empty() || addrval < _dense.data() || addrval >= _dense.data() + _dense.size())
+                return -1;
+            return _entities[addrval - _dense.data()];
+        }
+        /**
+         * @brief Move the component of an entity to a position of the dense array, the component at this position takes its place.
+         * Used by the owning groups of the registry to keep their components first.
+         *
+         * @param pos entity of the component to move, must have one
+         * @param index position in the dense array
+         */
+        void move_to(size_type pos, size_type index)
+        {
+            swap_positions(_sparse[pos], index);
+        }
+        /**
+         * @brief Sort the components of a range of the dense array in place, their entities follow them. The comparator
+         * only sees the components, it does not mark them as changed.
+         *
+         * @tparam Compare bool(Component const &, Component const &)
+         * @param comp strict weak ordering of the components
+         * @param first position of the range
+         * @param last end of the range, the end of the dense array by default
+         */
+        template <class Compare> void sort(Compare comp, size_type first = 0, size_type last = npos)
+        {
+            last = std::min(last, _dense.size());
+            if (first >= last)
+                return;
+            std::vector<size_type> order(last - first);
+
+            // order[i] is the position of the component that goes to first + i
+            for (size_type i = 0; i < order.size(); i++)
+                order[i] = i;
+            std::sort(order.begin(), order.end(), [this, first, &comp](size_type a, size_type b) {
+                return comp(std::as_const(_dense[first + a]), std::as_const(_dense[first + b]));
+            });
+            permute(_dense, order, first);
+            permute(_entities, order, first);
+            if constexpr (track_changes_v<Component>) {
+                permute(_added, order, first);
+                permute(_changed, order, first);
+            }
+            for (size_type i = first; i < last; i++)
+                _sparse[_entities[i]] = static_cast<index_type>(i);
+        }
+        /**
+         * @brief Sort a range of the dense array with an insertion sort, like sort. Linear when the components are nearly
+         * sorted, as when the sort keys change a little between two frames.
+         *
+         * @tparam Compare bool(Component const &, Component const &)
+         * @param comp strict weak ordering of the components
+         * @param first position of the range
+         * @param last end of the range, the end of the dense array by default
+         */
+        template <class Compare> void insertion_sort(Compare comp, size_type first = 0, size_type last = npos)
+        {
+            last = std::min(last, _dense.size());
+            for (size_type i = first + 1; i < last; i++) {
+                for (size_type j = i; j > first && comp(std::as_const(_dense[j]), std::as_const(_dense[j - 1])); j--)
+                    swap_positions(j, j - 1);
+            }
+        }
+
+        /**
+         * @brief Write the content of the packed_array. Trivially copyable components are copied in bulk, others need a serializer.
+         *
+         * @param writer to write to
+         */
+        void snapshot(binary_writer &writer) const
+        {
+            writer.write_size(_sparse.size());
+            writer.write_size(_dense.size());
+            writer.write_uints<std::uint32_t>(_entities.data(), _entities.size());
+            write_components(writer, _dense.data(), _dense.size());
+        }
+        /**
+         * @brief Replace the content of the packed_array by one written by snapshot
+         *
+         * @param reader to read from
+         */
+        void restore(binary_reader &reader)
+        {
+            size_type size = reader.read_size();
+
+            if (size > absent)
+                throw std::runtime_error("Invalid packed_array snapshot");
+            std::vector<index_type> sparse(size, absent);
+            std::vector<index_type> entities(reader.read_size());
+            container_t dense;
+
+            reader.read_uints<std::uint32_t>(entities.data(), entities.size());
+            if constexpr (std::is_trivially_copyable_v<Component>) {
+                dense.resize(entities.size());
+                reader.read_bytes(dense.data(), dense.size() * sizeof(Component));
+            } else {
+                dense.reserve(entities.size());
+                for (size_type i = 0; i < entities.size(); i++)
+                    dense.push_back(read_component<Component>(reader));
+            }
+            for (size_type i = 0; i < entities.size(); i++) {
+                if (entities[i] >= sparse.size())
+                    throw std::runtime_error("Invalid packed_array snapshot");
+                sparse[entities[i]] = static_cast<index_type>(i);
+            }
+            _dense = std::move(dense);
+            _entities = std::move(entities);
+            _sparse = std::move(sparse);
+            if constexpr (track_changes_v<Component>) {
+                _added.assign(_dense.size(), _tick);
+                _changed.assign(_dense.size(), _tick);
+            }
+            _log.reset(_tick);
+        }
+
+        /**
+         * @brief Set the tick stamped on the next tracked changes, called by the registry at each run_systems.
+         * The change log makes room for the next tick.
+         *
+         * @param tick current tick
+         */
+        void set_tick(tick_t tick)
+        {
+            if constexpr (track_changes_v<Component>)
+                _log.compact(_tick, _dense.size(), [this](size_type idx, tick_t last) { return is_last_change(idx, last); });
+            _tick = tick;
+        }
+        /**
+         * @brief Check if the component of an entity was added after a tick. Always false if the changes are not tracked.
+         *
+         * @param idx entity to check
+         * @param since tick
+         * @return true if it was added after since
+         */
+        bool is_added(size_type idx, tick_t since) const
+        {
+            if constexpr (track_changes_v<Component>)
+                return contains(idx) && _added[_sparse[idx]] > since;
+            (void)idx;
+            (void)since;
+            return false;
+        }
+        /**
+         * @brief Check if the component of an entity was added or mutably accessed after a tick. Always false if the changes are not tracked.
+         *
+         * @param idx entity to check
+         * @param since tick
+         * @return true if it changed after since
+         */
+        bool is_changed(size_type idx, tick_t since) const
+        {
+            if constexpr (track_changes_v<Component>)
+                return contains(idx) && _changed[_sparse[idx]] > since;
+            (void)idx;
+            (void)since;
+            return false;
+        }
+        /**
+         * @brief Get the entities whose component was added or mutably accessed after a tick, in increasing order.
+         * They are read from the change log, so the cost depends on the number of changes and not on the number of components,
+         * unless the log missed changes (see change_log).
+         *
+         * @param since tick
+         * @return std::vector<size_type>
+         */
+        std::vector<size_type> changes(tick_t since) const
+        {
+            std::vector<size_type> indexes;
+
+            if constexpr (track_changes_v<Component>) {
+                if (_log.covers(since)) {
+                    _log.for_each_since(since, [this, &indexes](size_type idx, tick_t last) {
+                        if (is_last_change(idx, last))
+                            indexes.push_back(idx);
+                    });
+                    std::sort(indexes.begin(), indexes.end());
+                    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+                    return indexes;
+                }
+                for (size_type i = 0; i < _dense.size(); i++) {
+                    if (_changed[i] > since)
+                        indexes.push_back(_entities[i]);
+                }
+                std::sort(indexes.begin(), indexes.end());
+            }
+            return indexes;
+        }
+        /**
+         * @brief Get the entities whose component was removed after a tick, in removal order
+         *
+         * @param since tick
+         * @return std::vector<size_type>
+         */
+        std::vector<size_type> removals(tick_t since) const
+        {
+            std::vector<size_type> indexes;
+            auto first = std::upper_bound(_removed.begin(), _removed.end(), since, [](tick_t t, auto const &r) { return t < r.second; });
+
+            for (auto it = first; it != _removed.end(); ++it)
+                indexes.push_back(it->first);
+            return indexes;
+        }
+        /**
+         * @brief Forget the removals logged up to a tick, once every peer received them
+         *
+         * @param until tick
+         */
+        void trim_removals(tick_t until)
+        {
+            _removed.erase(std::remove_if(_removed.begin(), _removed.end(), [until](auto const &r) { return r.second <= until; }), _removed.end());
+        }
+
+    private:
+        template <typename Value> reference_type emplace(size_type pos, Value &&component)
+        {
+            if (pos >= absent)
+                throw std::out_of_range("Index out of range");
+            if (pos >= _sparse.size()) {
+                if (pos >= _sparse.capacity())
+                    _resizes++;
+                _sparse.resize(pos + 1, absent);
+            }
+            if (_sparse[pos] != absent) {
+                _dense[_sparse[pos]] = std::forward<Value>(component);
+                touch(_sparse[pos]);
+            } else {
+                if (_dense.size() == _dense.capacity())
+                    _resizes++;
+                _sparse[pos] = static_cast<index_type>(_dense.size());
+                _dense.push_back(std::forward<Value>(component));
+                _entities.push_back(static_cast<index_type>(pos));
+                if constexpr (track_changes_v<Component>) {
+                    _added.push_back(_tick);
+                    _changed.push_back(_tick);
+                    _log.push(pos, _tick);
+                }
+            }
+            return reference_type(&_dense[_sparse[pos]]);
+        }
+        // moves the values of a range so that first + i receives the value at first + order[i]
+        template <class Vector> static void permute(Vector &values, std::vector<size_type> const &order, size_type first)
+        {
+            std::vector<typename Vector::value_type> sorted;
+
+            sorted.reserve(order.size());
+            for (size_type i : order)
+                sorted.push_back(std::move(values[first + i]));
+            std::move(sorted.begin(), sorted.end(), values.begin() + first);
+        }
+        void swap_positions(size_type a, size_type b)
+        {
+            if (a == b)
+                return;
+            std::swap(_dense[a], _dense[b]);
+            std::swap(_entities[a], _entities[b]);
+            _sparse[_entities[a]] = static_cast<index_type>(a);
+            _sparse[_entities[b]] = static_cast<index_type>(b);
+            if constexpr (track_changes_v<Component>) {
+                std::swap(_added[a], _added[b]);
+                std::swap(_changed[a], _changed[b]);
+            }
+        }
+        void touch(size_type dense)
+        {
+            if constexpr (track_changes_v<Component>) {
+                if (_changed[dense] != _tick) {
+                    _changed[dense] = _tick;
+                    _log.record_change(_entities[dense], _tick);
+                }
+            }
+            (void)dense;
+        }
+        void touch_all()
+        {
+            if constexpr (track_changes_v<Component>) {
+                if (_touched_all == _tick)
+                    return;
+                for (size_type dense = 0; dense < _dense.size(); dense++)
+                    touch(dense);
+                _touched_all = _tick;
+            }
+        }
+        bool is_last_change(size_type idx, tick_t tick) const
+        {
+            return contains(idx) && _changed[_sparse[idx]] == tick;
+        }
+
+    private:
+        container_t _dense;
+        std::vector<index_type> _entities;
+        std::vector<index_type> _sparse;
+        tick_t _tick = 1;
+        tick_t _touched_all = 0; /**< tick at which all the components were last stamped as changed by touch_all */
+        std::vector<tick_t> _added;
+        std::vector<tick_t> _changed;
+        std::vector<std::pair<size_type, tick_t>> _removed;
+        change_log _log;
+        size_type _resizes = 0;
+    };
+}
+
+#endif /* !PACKED_ARRAY_HPP_ */
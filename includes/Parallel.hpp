@@ -0,0 +1,98 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Parallel
+*/
+
+#ifndef PARALLEL_HPP_
+#define PARALLEL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <tuple>
+#include "Thread_pool.hpp"
+#include "Zipper.hpp"
+
+namespace ecs {
+    /**
+     * @brief Default number of positions under which par_for_each runs on the calling thread
+     *
+     */
+    inline constexpr std::size_t par_for_each_threshold = 4096;
+
+    /**
+     * @brief Call a function on every entity of a zipper, splitting the iteration in chunks run on a thread pool.
+     * The chunks cover whole blocks of 64 positions so two threads do not write the same cache lines of a container.
+     * The function receives the id and the components of an entity, like the values of the zipper:
+     * @code
+     * ecs::par_for_each(ecs::zipper(positions, velocities), [](std::size_t id, position &pos, velocity const &vel) {
+     *     pos.x += vel.x;
+     * });
+     * @endcode
+     * The result does not depend on the number of threads as long as the function only writes the components of its own entity.
+     *
+     * @tparam Zipper
+     * @tparam Function
+     * @param z zipper to iterate over
+     * @param f function to call for each entity
+     * @param threshold number of positions under which the iteration runs on the calling thread
+     * @param pool thread pool running the chunks
+     */
+    template <class Zipper, typename Function>
+    void par_for_each(Zipper &&z, Function &&f, std::size_t threshold = par_for_each_threshold, thread_pool &pool = thread_pool::shared())
+    {
+        constexpr std::size_t block = 64;
+        std::size_t size = z.size();
+
+        if (size < std::max<std::size_t>(threshold, 1) || pool.size() < 2) {
+            for (auto it = z.begin(); it != z.end(); ++it)
+                std::apply(f, *it);
+            return;
+        }
+
+        std::size_t chunk = std::max(threshold, (size + pool.size() * 4 - 1) / (pool.size() * 4));
+        chunk = (chunk + block - 1) / block * block;
+        std::size_t chunks = (size + chunk - 1) / chunk;
+        std::atomic<std::size_t> remaining(chunks);
+#ifdef ECS_PROFILING
+        std::atomic<std::size_t> iterated(0);
+#endif
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        for (std::size_t c = 0; c < chunks; c++) {
+            pool.submit([&, c]() {
+                std::size_t to = std::min(size, (c + 1) * chunk);
+#ifdef ECS_PROFILING
+                // the entities of the chunk are counted on the thread that called par_for_each, whichever thread runs it
+                std::size_t before = detail::iterated_entities;
+#endif
+
+                try {
+                    for (auto it = z.begin(c * chunk, to); it != z.end(to); ++it)
+                        std::apply(f, *it);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+#ifdef ECS_PROFILING
+                iterated += detail::iterated_entities - before;
+                detail::iterated_entities = before;
+#endif
+                remaining--;
+            });
+        }
+        pool.wait_until([&remaining]() { return remaining == 0; });
+#ifdef ECS_PROFILING
+        detail::iterated_entities += iterated;
+#endif
+        if (error)
+            std::rethrow_exception(error);
+    }
+}
+
+#endif /* !PARALLEL_HPP_ */
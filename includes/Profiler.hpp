@@ -0,0 +1,243 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Profiler
+*/
+
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Json.hpp"
+
+namespace ecs {
+    namespace detail {
+        /**
+         * @brief Number of entities given by the zippers and the groups on this thread, read by the registry around each system
+         *
+         */
+        inline thread_local std::size_t iterated_entities = 0;
+    }
+
+    /**
+     * @brief Record the time spent in the systems and the event handlers. The registry only feeds it when the engine is
+     * compiled with ECS_PROFILING defined, otherwise no measure is taken at all.
+     * The statistics cover the whole run, the histograms and the Chrome trace cover the last frames.
+     *
+     */
+    class profiler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t histogram_buckets = 16; /**< bucket i counts the calls lasting less than 2^i microseconds, the last one the longer calls */
+        static constexpr std::size_t max_frame_events = 65536; /**< calls kept in a frame, the frame is closed when it reaches it,
+                                                                  so the calls made without run_systems do not grow it forever */
+
+        /**
+         * @brief Statistics of a system or an event handler
+         *
+         */
+        struct zone_stats {
+            std::string name;
+            std::string category;
+            std::uint64_t calls = 0;
+            std::uint64_t entities = 0; /**< entities processed by the calls, summed: the entities given to a system by its zippers
+                                           and groups, the entities given to a handler */
+            double total_us = 0;
+            double max_us = 0;
+            double last_us = 0;
+            std::array<std::uint32_t, histogram_buckets> histogram{}; /**< durations of the calls in the kept frames */
+        };
+
+        /**
+         * @brief Construct a new profiler object
+         *
+         * @param frames number of frames kept for the histograms and the Chrome trace
+         */
+        explicit profiler(std::size_t frames = 120) : _frames(frames), _origin(clock::now()) {}
+
+        /**
+         * @brief Declare a system or an event handler to measure
+         *
+         * @param name shown in the statistics and the trace
+         * @param category of the zone, "system" or "event"
+         * @return std::size_t id to give to record
+         */
+        std::size_t add_zone(std::string name, std::string category)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            zone_stats zone;
+
+            zone.name = std::move(name);
+            zone.category = std::move(category);
+            _zones.push_back(std::move(zone));
+            return _zones.size() - 1;
+        }
+        /**
+         * @brief Record a call of a zone, ending now. Can be called from several threads.
+         *
+         * @param zone id returned by add_zone
+         * @param start of the call
+         * @param entities number of entities processed by the call
+         */
+        void record(std::size_t zone, clock::time_point start, std::size_t entities)
+        {
+            clock::time_point end = clock::now();
+            double duration = std::chrono::duration<double, std::micro>(end - start).count();
+            std::lock_guard<std::mutex> lock(_mutex);
+            zone_stats &stats = _zones[zone];
+
+            stats.calls++;
+            stats.entities += entities;
+            stats.total_us += duration;
+            stats.last_us = duration;
+            if (duration > stats.max_us)
+                stats.max_us = duration;
+            stats.histogram[bucket(duration)]++;
+            _current.push_back({zone, thread_index(), std::chrono::duration<double, std::micro>(start - _origin).count(), duration, entities});
+            if (_current.size() >= max_frame_events)
+                close_frame();
+        }
+        /**
+         * @brief Close the current frame. The oldest frame is dropped from the histograms and the trace when too many are kept.
+         *
+         */
+        void end_frame()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            close_frame();
+        }
+        /**
+         * @brief Change the number of frames kept for the histograms and the Chrome trace
+         *
+         * @param frames
+         */
+        void set_frame_window(std::size_t frames)
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            _frames = frames;
+            drop_old_frames();
+        }
+        /**
+         * @brief Get the statistics of all the zones, in the order they were declared
+         *
+         * @return std::vector<zone_stats>
+         */
+        std::vector<zone_stats> stats() const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            return _zones;
+        }
+        /**
+         * @brief Clear the statistics and the kept frames, the zones stay declared
+         *
+         */
+        void reset()
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            for (auto &zone : _zones)
+                zone = zone_stats{zone.name, zone.category};
+            _history.clear();
+            _current.clear();
+        }
+        /**
+         * @brief Write the kept frames in the Chrome trace format, open it in chrome://tracing or Perfetto
+         *
+         * @param out stream to write to
+         */
+        void write_chrome_trace(std::ostream &out) const
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            bool first = true;
+
+            out << "{\"traceEvents\":[";
+            for (auto const &frame : _history) {
+                for (auto const &e : frame) {
+                    out << (first ? "\n" : ",\n") << "{\"name\":\"" << detail::json_escape(_zones[e.zone].name) << "\",\"cat\":\"" << _zones[e.zone].category
+                        << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.thread << ",\"ts\":" << e.start_us << ",\"dur\":" << e.duration_us
+                        << ",\"args\":{\"entities\":" << e.entities << "}}";
+                    first = false;
+                }
+            }
+            out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        }
+        /**
+         * @brief Write the kept frames in a Chrome trace file
+         *
+         * @param path of the file
+         * @return true if the file was written
+         */
+        bool save_chrome_trace(std::string const &path) const
+        {
+            std::ofstream out(path);
+
+            if (!out)
+                return false;
+            write_chrome_trace(out);
+            return static_cast<bool>(out);
+        }
+
+    private:
+        struct trace_event {
+            std::size_t zone;
+            std::size_t thread;
+            double start_us;
+            double duration_us;
+            std::size_t entities;
+        };
+
+        static std::size_t bucket(double duration_us)
+        {
+            std::size_t i = 0;
+
+            while (i + 1 < histogram_buckets && duration_us >= static_cast<double>(std::uint64_t(1) << i))
+                i++;
+            return i;
+        }
+        void close_frame()
+        {
+            _history.push_back(std::move(_current));
+            _current.clear();
+            drop_old_frames();
+        }
+        void drop_old_frames()
+        {
+            while (_history.size() > _frames) {
+                for (auto const &e : _history.front())
+                    _zones[e.zone].histogram[bucket(e.duration_us)]--;
+                _history.pop_front();
+            }
+        }
+        std::size_t thread_index()
+        {
+            auto it = _threads.try_emplace(std::this_thread::get_id(), _threads.size()).first;
+
+            return it->second;
+        }
+
+        std::size_t _frames;
+        clock::time_point _origin;
+        std::vector<zone_stats> _zones;
+        std::vector<trace_event> _current;
+        std::deque<std::vector<trace_event>> _history;
+        std::unordered_map<std::thread::id, std::size_t> _threads;
+        mutable std::mutex _mutex;
+    };
+}
+
+#endif /* !PROFILER_HPP_ */
@@ -1,12 +1,22 @@
 #ifndef REGISTRY_HPP_
 #define REGISTRY_HPP_
 
+#include <algorithm>
 #include <any>
+#include <atomic>
+#include <exception>
 #include <functional>
 #include <typeindex>
+#include <type_traits>
 #include <unordered_map>
 #include <filesystem>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
 
 #ifdef _WIN32
 #define NOMINMAX
@@ -16,7 +26,15 @@
 #endif
 
 #include "Entity.hpp"
-#include "Sparse_array.hpp"
+#include "Entity_allocator.hpp"
+#include "Event_channel.hpp"
+#include "Component_id.hpp"
+#include "Change_tracking.hpp"
+#include "Component_storage.hpp"
+#include "Thread_pool.hpp"
+#include "Profiler.hpp"
+#include "Registry_stats.hpp"
+#include "Serialization.hpp"
 
 namespace ecs {
     /**
@@ -24,177 +42,1702 @@ namespace ecs {
      *
      */
     class registry {
+    public:
+        class prefab;
+
+    private:
         template<class Component, class ObjectType> using serializerFunction = std::function<Component(ObjectType &)>;
         template<class ObjectType> using componentCreator = std::function<void(entity, ObjectType &)>;
-        template<class ObjectType> using serializerMap = std::unordered_map<std::string, componentCreator<ObjectType>>;
+        template<class ObjectType> using prefabCompiler = std::function<void(prefab &, ObjectType &)>;
+        template<class ObjectType> struct namedComponent {
+            componentCreator<ObjectType> add;
+            prefabCompiler<ObjectType> compile;
+        };
+        template<class ObjectType> using serializerMap = std::unordered_map<std::string, namedComponent<ObjectType>>;
+
     public:
         // component managing
         /**
          * @brief Register a component type to the registry
          *
          * @tparam Component to register
-         * @return sparse_array of the registered component
+         * @return container of the registered component, see component_storage
          */
-        template <class Component> sparse_array<Component> &register_component()
+        template <class Component> storage_t<Component> &register_component()
         {
-            _components_array[std::type_index(typeid(Component))] =
-                sparse_array<Component>();
-            _remove_component_functions.push_back([](registry &reg, entity e) {
-                reg.get_components<Component>().erase(e);
-            });
+            set_pool<Component>();
+            return get_components<Component>();
+        }
+        /**
+         * @brief Register a component type with a name. The name finds its pool in the snapshots and the deltas, so they
+         * can be read by a build whose compiler names the type differently. Each function builds the component from a
+         * serialized object, to add it by name (see add_component).
+         *
+         * @tparam Component to register
+         * @tparam ObjectType types of the serialized objects, one per function
+         * @param component_name name of the component
+         * @param f Component(ObjectType &) functions
+         * @return container of the registered component, see component_storage
+         */
+        template <class Component, typename... ObjectType, typename... Function>
+        storage_t<Component> &register_component(const std::string &component_name, Function &&...f)
+        {
+            set_pool<Component>();
+            _components_array[component_id<Component>()]->key = component_name;
+            (put_in_map<Component, ObjectType>(component_name, f), ...);
             return get_components<Component>();
         }
 
-        template <class Component, typename... ObjectType, typename... Function>
-        sparse_array<Component> &register_component(const std::string &component_name, Function &&...f)
-        {
-            _components_array[std::type_index(typeid(Component))] =
-                sparse_array<Component>();
-            _remove_component_functions.push_back([](registry &reg, entity e) {
-                reg.get_components<Component>().erase(e);
-            });
-            (put_in_map<Component, ObjectType>(component_name, f), ...);
-            return get_components<Component>();
-        }
+        template <class Component, typename ObjectType, typename Function>
+        void put_in_map(const std::string &component_name, Function &&f)
+        {
+            if (_components_from_type.find(std::type_index(typeid(ObjectType))) == _components_from_type.end()) {
+                _components_from_type[std::type_index(typeid(ObjectType))] = serializerMap<ObjectType>();
+            }
+            serializerMap<ObjectType> &map = std::any_cast<serializerMap<ObjectType> &>(_components_from_type[std::type_index(typeid(ObjectType))]);
+            if (map.find(component_name) == map.end() || _reloading) {
+                // f is copied in the closures, the function given to register_component may be a temporary
+                map.insert_or_assign(component_name, namedComponent<ObjectType>{
+                    [this, f](entity e, ObjectType &v) {
+                        add_component<Component>(e, f(v));
+                    },
+                    [f](prefab &to, ObjectType &v) {
+                        to.template add<Component>(f(v));
+                    }});
+            }
+        }
+
+        /**
+         * @brief Get the container of a component
+         *
+         * @tparam Component to get
+         * @return container of the component, see component_storage
+         */
+        template <class Component> storage_t<Component> &get_components()
+        {
+            return get_pool<Component>().array;
+        }
+        /**
+         * @brief Get the container of a component (const)
+         *
+         * @tparam Component to get
+         * @return container of the component, see component_storage
+         */
+        template <class Component>
+        storage_t<Component> const &get_components() const
+        {
+            return get_pool<Component>().array;
+        }
+
+        // entity managing
+        /**
+         * @brief Create an entity. Lock-free, can be called from any thread, even while the systems run.
+         * Its components must be added by the thread running the systems, or staged (see stage_component).
+         *
+         * @return entity created
+         */
+        entity spawn_entity()
+        {
+            return make_entity(_ids.allocate());
+        }
+        /**
+         * @brief Create several entities at once. The freed ids are reused first, the others are a contiguous block of new
+         * ids reserved with a single atomic operation, so on a registry where no entity was killed the ids form one range.
+         * Lock-free like spawn_entity.
+         *
+         * @param count number of entities to create
+         * @return std::vector<entity> entities created
+         */
+        std::vector<entity> spawn_entities(std::size_t count)
+        {
+            std::vector<entity> spawned;
+            std::size_t id;
+
+            spawned.reserve(count);
+            while (spawned.size() < count && _ids.reuse(id))
+                spawned.push_back(make_entity(id));
+            if (spawned.size() < count) {
+                std::size_t first = _ids.allocate_block(count - spawned.size());
+
+                for (std::size_t i = first; spawned.size() < count; i++)
+                    spawned.push_back(make_entity(i));
+            }
+            return spawned;
+        }
+        /**
+         * @brief Get the entity currently using an index, with the generation of the index.
+         * Throws a std::runtime_error if the index does not fit in a handle (see ECS_ENTITY_INDEX_BITS).
+         *
+         * @param index of the entity
+         * @return entity
+         */
+        entity entity_from_index(size_t index) const
+        {
+            return make_entity(index);
+        }
+        /**
+         * @brief Get an entity from a handle, as returned by entity::handle. Check it with alive before using it.
+         *
+         * @param handle index and generation of the entity
+         * @return entity
+         */
+        entity entity_from_handle(entity::handle_type handle) const
+        {
+            return entity(handle & entity::index_mask, handle >> entity::index_bits);
+        }
+        /**
+         * @brief Check if an entity was created and not killed since. A handle kept after the death of its entity stays
+         * dead even when its index is reused, as the generation of the index changed.
+         *
+         * @param e entity to check
+         * @return true if the entity is alive
+         */
+        bool alive(entity const &e) const
+        {
+            return e.index() < _ids.issued() && !_ids.is_free(e.index())
+                && (_ids.generation(e.index()) & entity::generation_mask) == e.generation();
+        }
+
+    private:
+        // a handle given by spawn_entity whose entity died; an index never given (see entity_from_index) is not stale
+        bool stale(entity const &e) const
+        {
+            return e.index() < _ids.issued() && !alive(e);
+        }
+        void check_alive(entity const &e) const
+        {
+            if (stale(e))
+                throw std::runtime_error("Entity " + std::to_string(e.index()) + " (generation " + std::to_string(e.generation()) + ") is dead");
+        }
+
+    public:
+        /**
+         * @brief Kill an entity, only the pools of the components in its signature are visited.
+         * A dead entity (see alive) is ignored, so a stale handle cannot kill the entity that reused its index.
+         *
+         * @param e entity to kill
+         */
+        void kill_entity(entity e)
+        {
+            // an index never given by spawn_entity (see entity_from_index) only loses its components
+            bool issued = e.index() < _ids.issued();
+
+            if (stale(e))
+                return;
+            if (e < _signatures.size()) {
+                signature owned = _signatures[e] & ~_archetype_components;
+
+                if (!_groups.empty())
+                    update_groups(e, _signatures[e], signature());
+
+                if ((_signatures[e] & _archetype_components).any())
+                    _archetypes.destroy(e);
+
+                for (std::size_t id = 0; owned.any(); id++) {
+                    if (owned.test(id)) {
+                        owned.reset(id);
+                        _components_array[id]->erase(e);
+                    }
+                }
+                _signatures[e].reset();
+            }
+            if (issued)
+                _ids.release(e);
+        }
+        /**
+         * @brief add a component to an entity. Throws a std::runtime_error if the entity is dead (see alive), so a stale
+         * handle cannot give a component to the entity that reused its index.
+         *
+         * @tparam Component type to add
+         * @param to entity to receive the component
+         * @param component to add to the entity
+         * @return reference to the component added
+         */
+        template <typename Component>
+        decltype(auto) add_component(entity const &to, Component &&component)
+        {
+            auto &components = get_components<Component>();
+
+            check_alive(to);
+
+            if (to >= _signatures.size())
+                _signatures.resize(to + 1);
+            signature before = _signatures[to];
+            _signatures[to].set(component_id<Component>());
+            decltype(auto) inserted = components.insert_at(to, std::forward<Component>(component));
+
+            if (!_groups.empty() && before != _signatures[to]) {
+                update_groups(to, before, _signatures[to]);
+                // an owning group may have moved the component
+                if constexpr (packable<std::decay_t<Component>>::value)
+                    return components[to];
+            }
+            return inserted;
+        }
+
+        /**
+         * @brief Add a component to several entities. The pool is looked up and grown once for the whole batch, then the
+         * components are moved in place when the values are given as an rvalue.
+         * Throws a std::runtime_error, before adding anything, if one of the entities is dead.
+         *
+         * @tparam Component type to add
+         * @param to entities to receive the components
+         * @param values components to add, one per entity, in the same order
+         */
+        template <typename Component, typename Entities, typename Values>
+        void add_components(Entities const &to, Values &&values)
+        {
+            auto &components = get_components<Component>();
+            std::size_t id = component_id<Component>();
+            std::size_t size = 0;
+            std::size_t count = 0;
+
+            for (entity const &e : to) {
+                check_alive(e);
+                size = std::max<std::size_t>(size, e + 1);
+                count++;
+            }
+            if (count != static_cast<std::size_t>(std::distance(std::begin(values), std::end(values))))
+                throw std::runtime_error("add_components: " + std::to_string(count) + " entities but "
+                    + std::to_string(std::distance(std::begin(values), std::end(values))) + " components");
+            components.reserve(size, count);
+            if (_signatures.size() < size)
+                _signatures.resize(size);
+            auto value = std::begin(values);
+            for (entity const &e : to) {
+                signature before = _signatures[e];
+
+                _signatures[e].set(id);
+                if constexpr (std::is_rvalue_reference_v<Values &&>)
+                    components.insert_at(e, std::move(*value));
+                else
+                    components.insert_at(e, *value);
+                if (!_groups.empty())
+                    update_groups(e, before, _signatures[e]);
+                ++value;
+            }
+        }
+
+        template <typename ObjectType>
+        void add_component(const std::string &component_name, const entity &to, ObjectType &object)
+        {
+            get_named_component<std::remove_reference_t<ObjectType>>(component_name).add(to, object);
+        }
+
+        /**
+         * @brief remove a component from an entity. A dead entity is ignored, like by kill_entity.
+         *
+         * @tparam Component type to remove
+         * @param from entity to remove the component from
+         */
+        template <typename Component> void remove_component(entity const &from)
+        {
+            if (stale(from))
+                return;
+            if (from < _signatures.size()) {
+                signature before = _signatures[from];
+
+                _signatures[from].reset(component_id<Component>());
+                if (!_groups.empty())
+                    update_groups(from, before, _signatures[from]);
+            }
+            get_components<Component>().template erase<Component>(from);
+        }
+        /**
+         * @brief Get the max entity count of the registry
+         *
+         * @return int max entity count
+         */
+        int get_max_entity_count() const
+        {
+            return static_cast<int>(_ids.issued());
+        }
+
+        /**
+         * @brief Check if an entity has a component. It tests the signature of the entity, so it only knows the components
+         * added and removed through the registry, not the ones inserted directly in a container.
+         *
+         * @tparam Component to check
+         * @param e entity to check
+         * @return true or false
+         */
+        template <typename Component> bool has_component(entity const &e) const
+        {
+            std::size_t id = component_id<Component>();
+
+            return e < _signatures.size() && id < _signatures[e].size() && _signatures[e].test(id);
+        }
+        /**
+         * @brief Get the storage shared by the components stored in archetypes, see component_storage
+         *
+         * @return archetype_storage&
+         */
+        archetype_storage &archetypes()
+        {
+            return _archetypes;
+        }
+        /**
+         * @brief Get the signature of an entity, the set of the ids of the components it has
+         *
+         * @param e entity
+         * @return signature
+         */
+        signature get_signature(entity const &e) const
+        {
+            return e < _signatures.size() ? _signatures[e] : signature();
+        }
+
+        // resources
+        /**
+         * @brief Create the resource of a type, a single object shared by the systems (a spatial_grid, the game settings...).
+         * The previous resource of this type is replaced.
+         *
+         * @tparam Resource type of the resource
+         * @param args given to the constructor of the resource
+         * @return Resource& the resource created
+         */
+        template <class Resource, typename... Args> Resource &set_resource(Args &&...args)
+        {
+            auto resource = std::make_shared<Resource>(std::forward<Args>(args)...);
+
+            _resources[std::type_index(typeid(Resource))] = resource;
+            return *resource;
+        }
+        /**
+         * @brief Get the resource of a type. Throws a std::runtime_error if there is none.
+         *
+         * @tparam Resource type of the resource
+         * @return Resource&
+         */
+        template <class Resource> Resource &get_resource()
+        {
+            auto it = _resources.find(std::type_index(typeid(Resource)));
+
+            if (it == _resources.end())
+                throw std::runtime_error("No resource of type : " + std::string(typeid(Resource).name()));
+            return *static_cast<Resource *>(it->second.get());
+        }
+        /**
+         * @brief Check if there is a resource of a type
+         *
+         * @tparam Resource type of the resource
+         * @return true or false
+         */
+        template <class Resource> bool has_resource() const
+        {
+            return _resources.find(std::type_index(typeid(Resource))) != _resources.end();
+        }
+
+        // snapshot
+        /**
+         * @brief Write the whole state of the registry (entities, signatures and every registered pool) in a binary buffer.
+         * Trivially copyable components are copied in bulk, others need a serializer (see ecs::serializer).
+         * The pools are named by their key (see register_component) and the signatures are translated to the component ids
+         * of the restoring registry, so the snapshot does not depend on the order the component types got their id.
+         *
+         * @param buffer cleared then filled, reuse it between snapshots to avoid allocations
+         */
+        void snapshot(std::vector<std::byte> &buffer) const
+        {
+            binary_writer writer(buffer);
+
+            buffer.clear();
+            writer.write_uint(snapshot_magic);
+            std::vector<size_t> available_ids = _ids.free_ids();
+            std::vector<std::uint32_t> generations = _ids.generations();
+
+            writer.write_size(std::count_if(_components_array.begin(), _components_array.end(), [](auto const &p) { return p != nullptr; }));
+            for (std::size_t id = 0; id < _components_array.size(); id++) {
+                if (!_components_array[id])
+                    continue;
+                writer.write_string(_components_array[id]->key);
+                writer.write_uint<std::uint32_t>(id);
+            }
+            writer.write_size(_ids.issued());
+            writer.write_size(available_ids.size());
+            writer.write_uints<std::uint64_t>(available_ids.data(), available_ids.size());
+            writer.write_uints<std::uint32_t>(generations.data(), generations.size());
+            writer.write_size(_signatures.size());
+            for (auto const &sig : _signatures)
+                writer.write_bits(sig);
+            writer.write_size(std::count_if(_components_array.begin(), _components_array.end(), [](auto const &p) {
+                return p && !p->shared();
+            }));
+            for (auto const &p : _components_array) {
+                if (!p || p->shared())
+                    continue;
+                writer.write_string(p->key);
+                p->snapshot(writer);
+            }
+            _archetypes.snapshot(writer);
+        }
+        /**
+         * @brief Write the whole state of the registry in a new binary buffer
+         *
+         * @return std::vector<std::byte>
+         */
+        std::vector<std::byte> snapshot() const
+        {
+            std::vector<std::byte> buffer;
+
+            snapshot(buffer);
+            return buffer;
+        }
+        /**
+         * @brief Replace the state of the registry by a snapshot. The components of the snapshot must be registered,
+         * the pools of the components registered since the snapshot are emptied.
+         * Throws a std::runtime_error if the snapshot does not match the registry.
+         *
+         * @param buffer written by snapshot
+         */
+        void restore(std::vector<std::byte> const &buffer)
+        {
+            binary_reader reader(buffer);
+
+            if (reader.read_uint<std::uint32_t>() != snapshot_magic)
+                throw std::runtime_error("Invalid registry snapshot");
+            std::vector<std::size_t> ids = read_component_ids(reader);
+            std::vector<std::size_t> order;
+            std::size_t issued_ids = reader.read_size();
+            std::vector<size_t> available_ids(reader.read_size());
+            reader.read_uints<std::uint64_t>(available_ids.data(), available_ids.size());
+            std::vector<std::uint32_t> generations(issued_ids);
+            reader.read_uints<std::uint32_t>(generations.data(), generations.size());
+            std::vector<signature> signatures(reader.read_size());
+            for (auto &sig : signatures)
+                sig = detail::read_signature(reader, ids, order);
+            std::size_t pools = reader.read_size();
+            std::vector<bool> restored(_components_array.size(), false);
+
+            for (std::size_t i = 0; i < pools; i++) {
+                std::string name = reader.read_string();
+                auto it = std::find_if(_components_array.begin(), _components_array.end(), [&name](auto const &p) {
+                    return p && !p->shared() && name == p->key;
+                });
+
+                if (it == _components_array.end())
+                    throw std::runtime_error("Snapshot uses an unregistered component : " + name);
+                (*it)->restore(reader);
+                restored[it - _components_array.begin()] = true;
+            }
+            for (std::size_t id = 0; id < _components_array.size(); id++) {
+                if (_components_array[id] && !restored[id])
+                    _components_array[id]->clear();
+            }
+            _archetypes.restore(reader, ids);
+            _ids.reset(issued_ids, available_ids, generations);
+            _signatures = std::move(signatures);
+            rebuild_groups();
+        }
+
+        // statistics
+        /**
+         * @brief Get the memory and the occupancy of every registered pool, and the entity totals. Use it to find the pools
+         * that need compacting or another storage (see component_storage), see registry_stats::write_json to export it.
+         *
+         * @return registry_stats
+         */
+        registry_stats stats() const
+        {
+            registry_stats result;
+
+            for (auto const &p : _components_array) {
+                if (!p)
+                    continue;
+                result.pools.push_back(p->stats());
+                result.bytes += result.pools.back().bytes;
+            }
+            result.entities = _ids.issued();
+            result.free_ids = _ids.free_count();
+            result.alive = result.entities - result.free_ids;
+            return result;
+        }
+        /**
+         * @brief Reset the resize counts of the pools reported by stats
+         *
+         */
+        void reset_stats()
+        {
+            for (auto const &p : _components_array) {
+                if (p)
+                    p->reset_resize_count();
+            }
+            _archetypes.reset_resize_count();
+        }
+
+        // change tracking
+        /**
+         * @brief Get the current tick, stamped on the changes of the tracked components (see track_changes).
+         * It starts at 1 and is incremented at the beginning of each run_systems.
+         *
+         * @return tick_t
+         */
+        tick_t tick() const
+        {
+            return _tick;
+        }
+        /**
+         * @brief Write the changes of the tracked components made after a tick: the removed components, then the added or
+         * mutably accessed ones with their value. Components stored in archetypes are not tracked.
+         *
+         * @param buffer cleared then filled
+         * @param since last tick received by the peer, 0 to send every tracked component
+         */
+        void encode_delta(std::vector<std::byte> &buffer, tick_t since) const
+        {
+            binary_writer writer(buffer);
+
+            buffer.clear();
+            writer.write_uint(delta_magic);
+            writer.write_uint(_tick);
+            writer.write_size(_tracked_pools.size());
+            for (auto p : _tracked_pools) {
+                writer.write_string(p->key);
+                p->encode_delta(writer, since);
+            }
+        }
+        /**
+         * @brief Apply a delta written by encode_delta. The components are added and removed through the registry, on the
+         * same entity indexes as the sender; the components of an index this registry killed are dropped.
+         * Throws a std::runtime_error if the delta does not match the registry.
+         *
+         * @param buffer written by encode_delta
+         * @return tick_t tick of the sender, to give as since to its next encode_delta
+         */
+        tick_t apply_delta(std::vector<std::byte> const &buffer)
+        {
+            binary_reader reader(buffer);
+
+            if (reader.read_uint<std::uint32_t>() != delta_magic)
+                throw std::runtime_error("Invalid registry delta");
+            tick_t tick = reader.read_uint<tick_t>();
+            std::size_t pools = reader.read_size();
+
+            for (std::size_t i = 0; i < pools; i++) {
+                std::string name = reader.read_string();
+                auto it = std::find_if(_tracked_pools.begin(), _tracked_pools.end(), [&name](auto p) {
+                    return name == p->key;
+                });
+
+                if (it == _tracked_pools.end())
+                    throw std::runtime_error("Delta uses an untracked component : " + name);
+                (*it)->apply_delta(reader, *this);
+            }
+            return tick;
+        }
+        /**
+         * @brief Forget the removals logged up to a tick, call it with the oldest tick acknowledged by the peers
+         *
+         * @param until tick
+         */
+        void trim_changes(tick_t until)
+        {
+            for (auto p : _tracked_pools)
+                p->trim_removals(until);
+        }
+
+    // POOLS
+    private:
+        class pool_base {
+            public:
+                virtual ~pool_base() = default;
+                virtual void erase(std::size_t idx) = 0;
+                virtual char const *name() const = 0;
+                virtual bool shared() const = 0;
+                virtual void snapshot(binary_writer &writer) const = 0;
+                virtual void restore(binary_reader &reader) = 0;
+                virtual void clear() = 0;
+                virtual void set_tick(tick_t) {}
+                virtual void encode_delta(binary_writer &, tick_t) const {}
+                virtual void apply_delta(binary_reader &, registry &) {}
+                virtual void trim_removals(tick_t) {}
+                virtual pool_stats stats() const = 0;
+                virtual void reset_resize_count() = 0;
+                std::string key; /**< name of the pool in the snapshots and the deltas: the name given to register_component, the demangled type name otherwise */
+        };
+        template <class Component, bool Shared = std::is_same_v<storage_t<Component>, archetype_storage>>
+        class pool : public pool_base {
+            public:
+                void erase(std::size_t idx) override { array.template erase<Component>(idx); }
+                char const *name() const override { return typeid(Component).name(); }
+                bool shared() const override { return false; }
+                void snapshot(binary_writer &writer) const override { array.snapshot(writer); }
+                void restore(binary_reader &reader) override { array.restore(reader); }
+                void clear() override { array.clear(); }
+                void set_tick(tick_t tick) override
+                {
+                    if constexpr (track_changes_v<Component>)
+                        array.set_tick(tick);
+                }
+                void encode_delta(binary_writer &writer, tick_t since) const override
+                {
+                    if constexpr (track_changes_v<Component>)
+                        encode_tracked(writer, since);
+                }
+                void apply_delta(binary_reader &reader, registry &reg) override
+                {
+                    if constexpr (track_changes_v<Component>)
+                        apply_tracked(reader, reg);
+                }
+                void trim_removals(tick_t until) override
+                {
+                    if constexpr (track_changes_v<Component>)
+                        array.trim_removals(until);
+                }
+                pool_stats stats() const override
+                {
+                    return make_pool_stats(name(), storage_name<Component>(), array.capacity(), array.live_count(), array.memory_usage(), array.resize_count());
+                }
+                void reset_resize_count() override { array.reset_resize_count(); }
+                storage_t<Component> array;
+            private:
+                void encode_tracked(binary_writer &writer, tick_t since) const
+                {
+                    std::vector<std::size_t> removed = array.removals(since);
+                    std::vector<std::size_t> changed = array.changes(since);
+
+                    writer.write_size(removed.size());
+                    writer.write_uints<std::uint64_t>(removed.data(), removed.size());
+                    writer.write_size(changed.size());
+                    writer.write_uints<std::uint64_t>(changed.data(), changed.size());
+                    for (auto idx : changed)
+                        write_components(writer, std::addressof(array.get(idx)), 1);
+                }
+                void apply_tracked(binary_reader &reader, registry &reg)
+                {
+                    std::vector<std::size_t> removed(reader.read_size());
+                    reader.read_uints<std::uint64_t>(removed.data(), removed.size());
+                    std::vector<std::size_t> changed(reader.read_size());
+                    reader.read_uints<std::uint64_t>(changed.data(), changed.size());
+
+                    for (auto idx : removed)
+                        reg.remove_component<Component>(reg.entity_from_index(idx));
+                    for (auto idx : changed) {
+                        Component value = read_component<Component>(reader);
+                        entity e = reg.entity_from_index(idx);
+
+                        // an index this registry killed is not given back to the entity of the sender
+                        if (!reg.stale(e))
+                            reg.add_component<Component>(e, std::move(value));
+                    }
+                }
+        };
+        template <class Component>
+        class pool<Component, true> : public pool_base {
+            public:
+                explicit pool(archetype_storage &storage) : array(storage) {}
+                void erase(std::size_t idx) override { array.template erase<Component>(idx); }
+                char const *name() const override { return typeid(Component).name(); }
+                bool shared() const override { return true; }
+                void snapshot(binary_writer &) const override {}
+                void restore(binary_reader &) override {}
+                // the tables are all replaced by archetype_storage::restore
+                void clear() override {}
+                pool_stats stats() const override
+                {
+                    std::size_t slots = 0;
+                    std::size_t live = 0;
+                    std::size_t bytes = 0;
+                    std::size_t resizes = 0;
+
+                    for (auto const &table : array.tables()) {
+                        if (auto column = table->find_column(component_id<Component>())) {
+                            slots += column->capacity();
+                            live += column->size();
+                            bytes += column->memory_usage();
+                            resizes += column->resize_count();
+                        }
+                    }
+                    return make_pool_stats(name(), "archetype_storage", slots, live, bytes, resizes);
+                }
+                // the columns are reset all at once by reset_stats
+                void reset_resize_count() override {}
+                archetype_storage &array;
+        };
+
+        entity make_entity(std::size_t index) const
+        {
+            if (index > entity::index_mask)
+                throw std::runtime_error("Too many entities, define ECS_ENTITY_INDEX_BITS to raise the limit of " + std::to_string(entity::index_mask + 1));
+            return entity(index, _ids.generation(index));
+        }
+        std::vector<std::size_t> read_component_ids(binary_reader &reader) const
+        {
+            std::size_t count = reader.read_size();
+            std::vector<std::size_t> ids;
+
+            for (std::size_t i = 0; i < count; i++) {
+                std::string key = reader.read_string();
+                std::size_t id = reader.read_uint<std::uint32_t>();
+                auto it = std::find_if(_components_array.begin(), _components_array.end(), [&key](auto const &p) {
+                    return p && key == p->key;
+                });
+
+                // bounds the table, no build has that many component types
+                if (id > 0xFFFF)
+                    throw std::runtime_error("Invalid registry snapshot");
+                if (id >= ids.size())
+                    ids.resize(id + 1, static_cast<std::size_t>(-1));
+                if (it != _components_array.end())
+                    ids[id] = it - _components_array.begin();
+            }
+            return ids;
+        }
+        template <class Component> static char const *storage_name()
+        {
+            if constexpr (std::is_same_v<storage_t<Component>, packed_array<Component>>)
+                return "packed_array";
+            else if constexpr (std::is_same_v<storage_t<Component>, soa_array<Component>>)
+                return "soa_array";
+            else
+                return "sparse_array";
+        }
+        static pool_stats make_pool_stats(char const *name, char const *storage, std::size_t slots, std::size_t live, std::size_t bytes, std::size_t resizes)
+        {
+            return pool_stats{demangle(name), storage, slots, live, bytes, slots ? static_cast<double>(live) / static_cast<double>(slots) : 0.0, resizes};
+        }
+
+        template <class Component> void set_pool()
+        {
+            if (&detail::component_id_counter() != _component_id_counter)
+                throw std::runtime_error("Component ids are not shared with the program loading the module, the program must export its symbols (ENABLE_EXPORTS or -rdynamic)");
+            std::size_t id = component_id<Component>();
+
+            if (id >= max_components)
+                throw std::runtime_error("Too many component types, define ECS_MAX_COMPONENTS to raise the limit of " + std::to_string(max_components));
+            if (id >= _components_array.size())
+                _components_array.resize(id + 1);
+            if (_components_array[id] && _reloading)
+                return;
+            if (_components_array[id])
+                _tracked_pools.erase(std::remove(_tracked_pools.begin(), _tracked_pools.end(), _components_array[id].get()), _tracked_pools.end());
+            if constexpr (std::is_same_v<storage_t<Component>, archetype_storage>) {
+                _components_array[id] = std::make_unique<pool<Component>>(_archetypes);
+                _archetypes.register_component<Component>();
+                _archetype_components.set(id);
+            } else {
+                _components_array[id] = std::make_unique<pool<Component>>();
+                if constexpr (track_changes_v<Component>) {
+                    _components_array[id]->set_tick(_tick);
+                    _tracked_pools.push_back(_components_array[id].get());
+                }
+            }
+            _components_array[id]->key = demangle(typeid(Component).name());
+        }
+        template <class Component> pool<Component> &get_pool()
+        {
+            std::size_t id = component_id<Component>();
+
+            if (id >= _components_array.size() || !_components_array[id])
+                throw std::runtime_error("Component not registered : " + std::string(typeid(Component).name()));
+            return static_cast<pool<Component> &>(*_components_array[id]);
+        }
+        template <class Component> pool<Component> const &get_pool() const
+        {
+            std::size_t id = component_id<Component>();
+
+            if (id >= _components_array.size() || !_components_array[id])
+                throw std::runtime_error("Component not registered : " + std::string(typeid(Component).name()));
+            return static_cast<pool<Component> const &>(*_components_array[id]);
+        }
+        template <typename ObjectType> namedComponent<ObjectType> &get_named_component(std::string const &component_name)
+        {
+            auto type = _components_from_type.find(std::type_index(typeid(ObjectType)));
+
+            if (type == _components_from_type.end())
+                throw std::runtime_error("No component registered for this type : " + std::string(typeid(ObjectType).name()));
+            serializerMap<ObjectType> &map = std::any_cast<serializerMap<ObjectType> &>(type->second);
+            auto it = map.find(component_name);
+            if (it == map.end())
+                throw std::runtime_error("No component registered for this type : " + component_name);
+            return it->second;
+        }
+
+    // COMMANDS
+    public:
+        /**
+         * @brief Record structural changes (spawn, kill, add and remove components) to apply them later in one batch.
+         * Systems use it to change entities without invalidating the containers they iterate over.
+         * Operations are grouped by component pool when applied, in the order they were recorded for each pool, each pool
+         * growing once for the batch, then the entities are killed.
+         *
+         */
+        class command_buffer {
+            public:
+                /**
+                 * @brief Construct a new command buffer object
+                 *
+                 * @param reg registry to apply the commands to
+                 */
+                explicit command_buffer(registry &reg) : _reg(reg) {}
+                command_buffer(command_buffer const &) = delete;
+                command_buffer &operator=(command_buffer const &) = delete;
+
+                /**
+                 * @brief Create an entity. Its id is reserved immediately, its components are added at the flush.
+                 *
+                 * @return entity created
+                 */
+                entity spawn_entity()
+                {
+                    return _reg.spawn_entity();
+                }
+                /**
+                 * @brief Record the addition of a component. It is dropped at the flush if the entity died in the meantime.
+                 *
+                 * @tparam Component type to add
+                 * @param to entity to receive the component
+                 * @param component to add to the entity
+                 */
+                template <typename Component> void add_component(entity const &to, Component &&component)
+                {
+                    get_bucket<std::decay_t<Component>>().ops.emplace_back(to, std::forward<Component>(component));
+                }
+                /**
+                 * @brief Record the removal of a component
+                 *
+                 * @tparam Component type to remove
+                 * @param from entity to remove the component from
+                 */
+                template <typename Component> void remove_component(entity const &from)
+                {
+                    get_bucket<Component>().ops.emplace_back(from, std::nullopt);
+                }
+                /**
+                 * @brief Record the death of an entity, applied after all the components changes
+                 *
+                 * @param e entity to kill
+                 */
+                void kill_entity(entity const &e)
+                {
+                    _kills.push_back(e);
+                }
+                /**
+                 * @brief Check if there is nothing recorded
+                 *
+                 * @return true if the buffer is empty
+                 */
+                bool empty() const
+                {
+                    return _used.empty() && _kills.empty();
+                }
+                /**
+                 * @brief Apply all the recorded operations to the registry, pool by pool, then clear the buffer
+                 *
+                 */
+                void flush()
+                {
+                    command_buffer *buffer = this;
+
+                    _reg.apply_commands(&buffer, 1);
+                }
+
+            private:
+                friend class registry;
+
+                class bucket_base {
+                    public:
+                        virtual ~bucket_base() = default;
+                        virtual bool empty() const = 0;
+                        virtual void measure(std::size_t &size, std::size_t &count) const = 0;
+                        virtual void reserve(registry &reg, std::size_t size, std::size_t count) = 0;
+                        virtual void apply(registry &reg) = 0;
+                };
+                template <class Component>
+                class bucket : public bucket_base {
+                    public:
+                        bool empty() const override
+                        {
+                            return ops.empty();
+                        }
+                        // highest entity plus one and number of additions, summed over the buffers flushed together
+                        void measure(std::size_t &size, std::size_t &count) const override
+                        {
+                            for (auto const &op : ops) {
+                                if (op.second) {
+                                    size = std::max<std::size_t>(size, op.first + 1);
+                                    count++;
+                                }
+                            }
+                        }
+                        void reserve(registry &reg, std::size_t size, std::size_t count) override
+                        {
+                            reg.get_components<Component>().reserve(size, count);
+                            if (reg._signatures.size() < size)
+                                reg._signatures.resize(size);
+                        }
+                        void apply(registry &reg) override
+                        {
+                            for (auto &op : ops) {
+                                // the entity may have been killed since the command was recorded
+                                if (reg.stale(op.first))
+                                    continue;
+                                if (op.second)
+                                    reg.add_component<Component>(op.first, std::move(*op.second));
+                                else
+                                    reg.remove_component<Component>(op.first);
+                            }
+                            ops.clear();
+                        }
+                        std::vector<std::pair<entity, std::optional<Component>>> ops;
+                };
+
+                template <class Component> bucket<Component> &get_bucket()
+                {
+                    std::size_t id = component_id<Component>();
+
+                    if (id >= _buckets.size())
+                        _buckets.resize(id + 1);
+                    if (!_buckets[id])
+                        _buckets[id] = std::make_unique<bucket<Component>>();
+                    auto &b = static_cast<bucket<Component> &>(*_buckets[id]);
+                    if (b.ops.empty())
+                        _used.push_back(id);
+                    return b;
+                }
+                bucket_base *used_bucket(std::size_t id) const
+                {
+                    return id < _buckets.size() && _buckets[id] && !_buckets[id]->empty() ? _buckets[id].get() : nullptr;
+                }
+
+            private:
+                registry &_reg;
+                std::vector<std::unique_ptr<bucket_base>> _buckets;
+                std::vector<std::size_t> _used;
+                std::vector<entity> _kills;
+        };
+
+        /**
+         * @brief Get the command buffer of the calling thread: each worker running the systems has its own,
+         * the thread calling run_systems uses the main one. The buffers are flushed after each priority level of run_systems.
+         *
+         * @return command_buffer&
+         */
+        command_buffer &commands()
+        {
+            std::size_t worker = _system_pool ? _system_pool->current_worker() : thread_pool::npos;
+            std::size_t index = worker == thread_pool::npos ? 0 : worker + 1;
+
+            while (_command_buffers.size() <= index)
+                _command_buffers.push_back(std::make_unique<command_buffer>(*this));
+            return *_command_buffers[index];
+        }
+        /**
+         * @brief Apply the operations recorded in all the command buffers, as one batch: the components changes of every
+         * buffer first, pool by pool and in the order of the buffers, then the kills of every buffer. A kill recorded by a
+         * worker thus never runs before an addition recorded for the same entity by another one.
+         *
+         */
+        void flush_commands()
+        {
+            std::vector<command_buffer *> buffers;
+
+            for (auto &buffer : _command_buffers)
+                buffers.push_back(buffer.get());
+            apply_commands(buffers.data(), buffers.size());
+        }
+
+    private:
+        void apply_commands(command_buffer *const *buffers, std::size_t count)
+        {
+            std::vector<std::size_t> ids;
+
+            for (std::size_t i = 0; i < count; i++) {
+                ids.insert(ids.end(), buffers[i]->_used.begin(), buffers[i]->_used.end());
+                buffers[i]->_used.clear();
+            }
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+            for (std::size_t id : ids) {
+                command_buffer::bucket_base *first = nullptr;
+                std::size_t size = 0;
+                std::size_t added = 0;
+
+                for (std::size_t i = 0; i < count; i++) {
+                    if (auto bucket = buffers[i]->used_bucket(id)) {
+                        bucket->measure(size, added);
+                        first = first ? first : bucket;
+                    }
+                }
+                first->reserve(*this, size, added);
+                for (std::size_t i = 0; i < count; i++) {
+                    if (auto bucket = buffers[i]->used_bucket(id))
+                        bucket->apply(*this);
+                }
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                for (auto const &e : buffers[i]->_kills)
+                    kill_entity(e);
+                buffers[i]->_kills.clear();
+            }
+        }
+
+    // STAGING
+    public:
+        /**
+         * @brief Stage the addition of a component from any thread, without lock. It is applied by the thread running the
+         * systems at the beginning of the next run_systems (or by merge_staged), in the order it was staged, and dropped
+         * if the entity died in the meantime.
+         *
+         * @tparam Component type to add
+         * @param to entity to receive the component, usually created with spawn_entity on the same thread
+         * @param component to add to the entity
+         */
+        template <typename Component> void stage_component(entity const &to, Component &&component)
+        {
+            push_staged([to, component = std::decay_t<Component>(std::forward<Component>(component))](registry &reg) mutable {
+                if (!reg.stale(to))
+                    reg.add_component(to, std::move(component));
+            });
+        }
+        /**
+         * @brief Stage the removal of a component from any thread, see stage_component
+         *
+         * @tparam Component type to remove
+         * @param from entity to remove the component from
+         */
+        template <typename Component> void stage_removal(entity const &from)
+        {
+            push_staged([from](registry &reg) { reg.remove_component<Component>(from); });
+        }
+        /**
+         * @brief Stage the death of an entity from any thread, see stage_component
+         *
+         * @param e entity to kill
+         */
+        void stage_kill(entity const &e)
+        {
+            push_staged([e](registry &reg) { reg.kill_entity(e); });
+        }
+        /**
+         * @brief Apply the staged operations, in the order they were staged. Called at the beginning of run_systems, after
+         * the new tick is set. Must be called by the thread running the systems; the other threads can keep staging meanwhile,
+         * what they stage after the start of the merge waits for the next one.
+         *
+         */
+        void merge_staged()
+        {
+            staged_op *op = _staged.head.exchange(nullptr, std::memory_order_acquire);
+            staged_op *ordered = nullptr;
+
+            // the stack gives the last staged first
+            while (op) {
+                staged_op *next = op->next;
+
+                op->next = ordered;
+                ordered = op;
+                op = next;
+            }
+            while (ordered) {
+                std::unique_ptr<staged_op> current(ordered);
+
+                ordered = ordered->next;
+                try {
+                    current->apply(*this);
+                } catch (...) {
+                    staged_list::destroy(ordered);
+                    throw;
+                }
+            }
+        }
+
+    private:
+        struct staged_op {
+            virtual ~staged_op() = default;
+            virtual void apply(registry &reg) = 0;
+            staged_op *next = nullptr;
+        };
+        template <class Function> struct staged_call : staged_op {
+            explicit staged_call(Function &&f) : f(std::move(f)) {}
+            void apply(registry &reg) override
+            {
+                f(reg);
+            }
+            Function f;
+        };
+        // lock-free stack of the staged operations, pushed by any thread and taken whole by merge_staged
+        struct staged_list {
+            staged_list() = default;
+            staged_list(staged_list const &) = delete;
+            staged_list &operator=(staged_list const &) = delete;
+            ~staged_list()
+            {
+                destroy(head.load());
+            }
+            static void destroy(staged_op *op)
+            {
+                while (op) {
+                    staged_op *next = op->next;
+
+                    delete op;
+                    op = next;
+                }
+            }
+            std::atomic<staged_op *> head{nullptr};
+        };
+
+        template <class Function> void push_staged(Function &&f)
+        {
+            staged_op *op = new staged_call<std::decay_t<Function>>(std::forward<Function>(f));
+
+            op->next = _staged.head.load(std::memory_order_relaxed);
+            while (!_staged.head.compare_exchange_weak(op->next, op, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+    // PREFABS
+    public:
+        /**
+         * @brief Set of typed components stamped together on entities. The named components are deserialized once when
+         * added to the prefab, instantiating it then only copies the values in the pools, without any string lookup.
+         *
+         */
+        class prefab {
+            public:
+                prefab() = default;
+                prefab(prefab const &other) : _ids(other._ids), _signature(other._signature)
+                {
+                    for (auto const &component : other._components)
+                        _components.push_back(component->clone());
+                }
+                prefab(prefab &&) = default;
+                prefab &operator=(prefab const &other)
+                {
+                    if (this != &other)
+                        *this = prefab(other);
+                    return *this;
+                }
+                prefab &operator=(prefab &&) = default;
+
+                /**
+                 * @brief Add a component to the prefab, replacing the one of the same type
+                 *
+                 * @tparam Component type to add
+                 * @param component value copied on each instantiated entity
+                 * @return prefab& for chaining
+                 */
+                template <typename Component> prefab &add(Component &&component)
+                {
+                    using value_type = std::decay_t<Component>;
+                    std::size_t id = component_id<value_type>();
+                    auto value = std::make_unique<typed_component<value_type>>(std::forward<Component>(component));
+                    auto it = std::find(_ids.begin(), _ids.end(), id);
+
+                    if (it != _ids.end()) {
+                        _components[it - _ids.begin()] = std::move(value);
+                    } else {
+                        _ids.push_back(id);
+                        _components.push_back(std::move(value));
+                        _signature.set(id);
+                    }
+                    return *this;
+                }
+                /**
+                 * @brief Check if the prefab has a component
+                 *
+                 * @tparam Component to check
+                 * @return true or false
+                 */
+                template <typename Component> bool has() const
+                {
+                    return _signature.test(component_id<Component>());
+                }
+                /**
+                 * @brief Get the signature given to the instantiated entities
+                 *
+                 * @return signature
+                 */
+                signature get_signature() const
+                {
+                    return _signature;
+                }
+
+            private:
+                friend class registry;
+
+                class component_base {
+                    public:
+                        virtual ~component_base() = default;
+                        virtual std::unique_ptr<component_base> clone() const = 0;
+                        virtual void stamp(registry &reg, std::vector<entity> const &to, std::size_t size) const = 0;
+                };
+                template <class Component>
+                class typed_component : public component_base {
+                    public:
+                        template <typename Value> explicit typed_component(Value &&v) : value(std::forward<Value>(v)) {}
+                        std::unique_ptr<component_base> clone() const override
+                        {
+                            return std::make_unique<typed_component>(value);
+                        }
+                        void stamp(registry &reg, std::vector<entity> const &to, std::size_t size) const override
+                        {
+                            auto &components = reg.get_components<Component>();
+
+                            components.reserve(size, to.size());
+                            for (entity const &e : to)
+                                components.insert_at(e, value);
+                        }
+                        Component value;
+                };
+
+                std::vector<std::unique_ptr<component_base>> _components;
+                std::vector<std::size_t> _ids;
+                signature _signature;
+        };
+
+        /**
+         * @brief Deserialize a named component and add it to a prefab, see register_component
+         *
+         * @tparam ObjectType type of the serialized object
+         * @param component_name name given at the registration of the component
+         * @param to prefab to receive the component
+         * @param object to deserialize
+         */
+        template <typename ObjectType>
+        void add_component(const std::string &component_name, prefab &to, ObjectType &object)
+        {
+            get_named_component<std::remove_reference_t<ObjectType>>(component_name).compile(to, object);
+        }
+        /**
+         * @brief Stamp a prefab on existing entities, the pools are grown once for all of them.
+         * Throws a std::runtime_error, before adding anything, if one of the entities is dead.
+         *
+         * @param from prefab to copy the components from
+         * @param to entities to receive the components
+         */
+        void instantiate(prefab const &from, std::vector<entity> const &to)
+        {
+            std::size_t size = 0;
+
+            for (entity const &e : to) {
+                check_alive(e);
+                size = std::max<std::size_t>(size, e + 1);
+            }
+            std::vector<signature> before;
+
+            if (_signatures.size() < size)
+                _signatures.resize(size);
+            if (!_groups.empty())
+                before.reserve(to.size());
+            for (entity const &e : to) {
+                if (!_groups.empty())
+                    before.push_back(_signatures[e]);
+                _signatures[e] |= from._signature;
+            }
+            for (auto const &component : from._components)
+                component->stamp(*this, to, size);
+            for (std::size_t i = 0; i < before.size(); i++)
+                update_groups(to[i], before[i], _signatures[to[i]]);
+        }
+        /**
+         * @brief Create entities from a prefab
+         *
+         * @param from prefab to copy the components from
+         * @param count number of entities to create
+         * @return std::vector<entity> entities created, see spawn_entities
+         */
+        std::vector<entity> instantiate(prefab const &from, std::size_t count)
+        {
+            std::vector<entity> spawned = spawn_entities(count);
+
+            instantiate(from, spawned);
+            return spawned;
+        }
+        /**
+         * @brief Create an entity from a prefab
+         *
+         * @param from prefab to copy the components from
+         * @return entity created
+         */
+        entity instantiate(prefab const &from)
+        {
+            return instantiate(from, 1).front();
+        }
+
+    // GROUPS
+    public:
+        template <class... Components> class group;
+
+        /**
+         * @brief List of the entities having a set of components, kept up to date by add_component, remove_component and
+         * kill_entity, so iterating it costs the number of matching entities. See get_group.
+         *
+         */
+        class group_base {
+            public:
+                group_base(group_base const &) = delete;
+                group_base &operator=(group_base const &) = delete;
+
+                /**
+                 * @brief Get the entities of the group, packed. In an owning group, the i-th entity owns the i-th component of each pool.
+                 *
+                 * @return std::vector<entity> const&
+                 */
+                std::vector<entity> const &entities() const
+                {
+                    return _entities;
+                }
+                std::vector<entity>::const_iterator begin() const
+                {
+                    return _entities.begin();
+                }
+                std::vector<entity>::const_iterator end() const
+                {
+                    return _entities.end();
+                }
+                /**
+                 * @brief Get the number of entities in the group
+                 *
+                 * @return std::size_t
+                 */
+                std::size_t size() const
+                {
+                    return _entities.size();
+                }
+                /**
+                 * @brief Check if an entity is in the group
+                 *
+                 * @param e entity to check
+                 * @return true or false
+                 */
+                bool contains(entity const &e) const
+                {
+                    return e < _positions.size() && _positions[e] != npos;
+                }
+                /**
+                 * @brief Check if the group owns its components, see get_owned_group
+                 *
+                 * @return true or false
+                 */
+                bool owned() const
+                {
+                    return _owned;
+                }
+
+            private:
+                friend class registry;
+                template <class...> friend class group;
+
+                using packer = void (registry::*)(entity, std::size_t);
+
+                group_base(registry &reg, signature mask, bool owned, std::vector<packer> &&packers)
+                    : _reg(reg), _mask(mask), _owned(owned), _packers(std::move(packers)) {}
+
+                static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+                bool matches(signature const &sig) const
+                {
+                    return (sig & _mask) == _mask;
+                }
+                void insert(entity e)
+                {
+                    if (e >= _positions.size())
+                        _positions.resize(e + 1, npos);
+                    _positions[e] = _entities.size();
+                    _entities.push_back(e);
+                    pack(e, _entities.size() - 1);
+                }
+                void remove(entity e)
+                {
+                    std::size_t idx = _positions[e];
+                    std::size_t last = _entities.size() - 1;
+
+                    pack(e, last);
+                    _entities[idx] = _entities[last];
+                    _positions[_entities[idx]] = idx;
+                    _entities.pop_back();
+                    _positions[e] = npos;
+                }
+                void clear()
+                {
+                    for (entity const &e : _entities)
+                        _positions[e] = npos;
+                    _entities.clear();
+                }
+                // order the entities like the components of a pool, an owning group moves its other pools along.
+                // Returns the number of entities whose component is before split in the pool.
+                template <class Container> std::size_t follow(Container const &components, std::size_t split)
+                {
+                    std::size_t i = 0;
+                    std::size_t before = 0;
+
+                    for (std::size_t pos = 0; pos < components.live_count() && i < _entities.size(); pos++) {
+                        if (pos == split)
+                            before = i;
+                        std::size_t idx = components.scan_index(pos);
+
+                        if (idx < _positions.size() && _positions[idx] != npos) {
+                            entity e = _reg.entity_from_index(idx);
+
+                            _entities[i] = e;
+                            _positions[idx] = i;
+                            pack(e, i++);
+                        }
+                    }
+                    return split < components.live_count() ? before : i;
+                }
+                // merge the two sorted runs left by follow when the pool has an owning group
+                template <class Container, class Compare> void merge_runs(Container const &components, std::size_t middle, Compare &comp)
+                {
+                    std::inplace_merge(_entities.begin(), _entities.begin() + middle, _entities.end(), [&components, &comp](entity a, entity b) {
+                        return comp(components.get(a), components.get(b));
+                    });
+                    for (std::size_t i = 0; i < _entities.size(); i++)
+                        _positions[_entities[i]] = i;
+                }
+                void pack(entity e, std::size_t index)
+                {
+                    if (_owned) {
+                        for (packer p : _packers)
+                            (_reg.*p)(e, index);
+                    }
+                }
+
+                registry &_reg;
+                signature _mask;
+                bool _owned;
+                std::vector<packer> _packers; /**< moves a component of each pool of an owning group */
+                std::vector<entity> _entities;
+                std::vector<std::size_t> _positions;
+                std::vector<std::pair<std::type_index, std::shared_ptr<void>>> _views; /**< group<Components...> sharing these entities, by type */
+        };
+        /**
+         * @brief Entities having all the given components. The groups of the same components in any order, const or not,
+         * share the same entities.
+         *
+         * @tparam Components of the group
+         */
+        template <class... Components>
+        class group {
+            public:
+                explicit group(group_base &members) : _members(members) {}
+                group(group const &) = delete;
+                group &operator=(group const &) = delete;
+
+                /**
+                 * @brief Get the entities of the group, packed. In an owning group, the i-th entity owns the i-th component of each pool.
+                 *
+                 * @return std::vector<entity> const&
+                 */
+                std::vector<entity> const &entities() const
+                {
+                    return _members.entities();
+                }
+                std::vector<entity>::const_iterator begin() const
+                {
+                    return _members.begin();
+                }
+                std::vector<entity>::const_iterator end() const
+                {
+                    return _members.end();
+                }
+                /**
+                 * @brief Get the number of entities in the group
+                 *
+                 * @return std::size_t
+                 */
+                std::size_t size() const
+                {
+                    return _members.size();
+                }
+                /**
+                 * @brief Check if an entity is in the group
+                 *
+                 * @param e entity to check
+                 * @return true or false
+                 */
+                bool contains(entity const &e) const
+                {
+                    return _members.contains(e);
+                }
+                /**
+                 * @brief Check if the group owns its components, see get_owned_group
+                 *
+                 * @return true or false
+                 */
+                bool owned() const
+                {
+                    return _members.owned();
+                }
+                /**
+                 * @brief Call a function on each entity of the group with its components, a const component is given as a
+                 * const reference. Components must not be added or removed during the iteration, use commands() instead.
+                 *
+                 * @param f function called with the entity and its components
+                 */
+                template <typename Function> void each(Function &&f)
+                {
+                    registry &reg = _members._reg;
+
+                    std::apply([this, &f](auto &...pools) {
+                        for (entity const &e : _members._entities)
+                            f(e, component<Components>(pools, e)...);
+                    }, std::tuple<decltype(reg.template system_argument<Components>())...>(reg.template system_argument<Components>()...));
+#ifdef ECS_PROFILING
+                    detail::iterated_entities += _members._entities.size();
+#endif
+                }
+
+                static signature mask()
+                {
+                    signature sig;
 
-        template <class Component, typename ObjectType, typename Function>
-        void put_in_map(const std::string &component_name, Function &&f)
-        {
-            if (_components_from_type.find(std::type_index(typeid(ObjectType))) == _components_from_type.end()) {
-                _components_from_type[std::type_index(typeid(ObjectType))] = std::unordered_map<std::string, std::function<void(entity, ObjectType &)>>();
-            }
-            serializerMap<ObjectType> &map = std::any_cast<serializerMap<ObjectType> &>(_components_from_type[std::type_index(typeid(ObjectType))]);
-            if (map.find(component_name) == map.end()) {
-                map.insert({component_name, [&](entity e, ObjectType v) {
-                    add_component<Component>(e, f(v));
-                }});
-            }
-        }
+                    (sig.set(component_id<std::remove_const_t<Components>>()), ...);
+                    return sig;
+                }
+
+            private:
+                template <class Component, class Storage> static decltype(auto) component(Storage &storage, entity const &e)
+                {
+                    if constexpr (std::is_same_v<std::remove_const_t<Storage>, archetype_storage>)
+                        return storage.template get<std::remove_const_t<Component>>(e);
+                    else
+                        return storage.get(e);
+                }
+
+                group_base &_members;
+        };
 
         /**
-         * @brief Get the sparse_array of a component
+         * @brief Get the group of the entities having all the given components, created on the first call.
+         * Creating it visits every entity once, then the registry keeps it up to date.
+         * @code
+         * reg.get_group<position, sprite const>().each([](ecs::entity e, position &pos, sprite const &spr) { ... });
+         * @endcode
          *
-         * @tparam Component to get
-         * @return sparse_array of the component
+         * @tparam Components of the group, const ones are given as const references by each
+         * @return group<Components...>&
          */
-        template <class Component> sparse_array<Component> &get_components()
+        template <class... Components> group<Components...> &get_group()
         {
-            return std::any_cast<sparse_array<Component> &>(
-                _components_array[std::type_index(typeid(Component))]);
+            return find_group<Components...>(false);
         }
         /**
-         * @brief Get the sparse_array of a component (const)
+         * @brief Get a group that also orders the pools of its components: the components of its entities come first in
+         * each pool, in the order of entities(), so they can be walked as contiguous arrays. The components must be stored
+         * in a packed_array or a soa_array, and a component can only be owned by one group.
+         * Throws a std::runtime_error if a component is already owned by another group.
          *
-         * @tparam Component to get
-         * @return sparse_array of the component
+         * @tparam Components of the group
+         * @return group<Components...>&
          */
-        template <class Component>
-        sparse_array<Component> const &get_components() const
+        template <class... Components> group<Components...> &get_owned_group()
         {
-            return std::any_cast<sparse_array<Component> const &>(
-                _components_array.at(std::type_index(typeid(Component))));
+            static_assert((packable<std::remove_const_t<Components>>::value && ...), "An owning group needs components stored in a packed_array or a soa_array");
+            return find_group<Components...>(true);
         }
 
-        // entity managing
-        /**
-         * @brief Create an entity
-         *
-         * @return entity created
-         */
-        entity spawn_entity()
+    private:
+        template <class Component, class = void> struct packable : std::false_type {};
+        template <class Component>
+        struct packable<Component, std::void_t<decltype(std::declval<storage_t<Component> &>().move_to(0, 0))>> : std::true_type {};
+
+        template <class Component> void pack_component(entity e, std::size_t index)
         {
-            if (_available_ids.empty()) {
-                return entity(_higgest_entity_id++);
-            } else {
-                auto id = _available_ids.back();
-                _available_ids.pop_back();
-                return entity(id);
-            }
+            if constexpr (packable<Component>::value)
+                get_components<Component>().move_to(e, index);
         }
-        /**
-         * @brief Get an entity from an index
-         *
-         * @param index of the entity
-         * @return entity
-         */
-        entity entity_from_index(size_t index) const
+        template <class... Components> group<Components...> &find_group(bool owned)
         {
-            return entity(index);
+            signature mask = group<Components...>::mask();
+            auto found = std::find_if(_groups.begin(), _groups.end(), [&mask, owned](auto const &g) { return g->_mask == mask && g->_owned == owned; });
+            group_base *members = found == _groups.end() ? &create_group(mask, owned, {&registry::pack_component<std::remove_const_t<Components>>...}) : found->get();
+            std::type_index type(typeid(group<Components...>));
+
+            for (auto const &[view_type, view] : members->_views) {
+                if (view_type == type)
+                    return *static_cast<group<Components...> *>(view.get());
+            }
+            auto view = std::make_shared<group<Components...>>(*members);
+
+            members->_views.emplace_back(type, view);
+            return *view;
         }
-        /**
-         * @brief Kill an entity
-         *
-         * @param e entity to kill
-         */
-        void kill_entity(entity e)
+        group_base &create_group(signature const &mask, bool owned, std::vector<group_base::packer> &&packers)
         {
-            for (auto &f : _remove_component_functions) {
-                f(*this, e);
+            if (owned && (_owned_components & mask).any())
+                throw std::runtime_error("A component of the group is already owned by another group");
+            std::unique_ptr<group_base> created(new group_base(*this, mask, owned, std::move(packers)));
+            group_base &ref = *created;
+
+            for (std::size_t e = 0; e < _signatures.size(); e++) {
+                if (ref.matches(_signatures[e]))
+                    ref.insert(entity_from_index(e));
             }
-            _available_ids.push_back(e);
+            if (owned)
+                _owned_components |= mask;
+            _groups.push_back(std::move(created));
+            return ref;
         }
-        /**
-         * @brief add a component to an entity
-         *
-         * @tparam Component type to add
-         * @param to entity to receive the component
-         * @param component to add to the entity
-         * @return sparse_array of the component
-         */
-        template <typename Component>
-        typename sparse_array<Component>::reference_type add_component(
-            entity const &to, Component &&component)
+        void update_groups(entity e, signature const &before, signature const &after)
         {
-            return get_components<Component>().insert_at(to,
-                std::forward<Component>(component));
-        }
+            for (auto &g : _groups) {
+                bool was = g->matches(before);
+                bool is = g->matches(after);
 
-        template <typename ObjectType>
-        void add_component(const std::string &component_name, const entity &to, ObjectType &object)
+                if (was && !is)
+                    g->remove(e);
+                else if (!was && is)
+                    g->insert(e);
+            }
+        }
+        void rebuild_groups()
         {
-            using unreferencedObjectType = std::remove_reference_t<ObjectType>;
-            if (_components_from_type.find(std::type_index(typeid(unreferencedObjectType))) == _components_from_type.end())
-                throw std::runtime_error("No component registered for this type : " + std::string(typeid(unreferencedObjectType).name()));
-            serializerMap<unreferencedObjectType> &map = std::any_cast<serializerMap<unreferencedObjectType> &>(_components_from_type[std::type_index(typeid(unreferencedObjectType))]);
-            if (map.find(component_name) == map.end())
-                throw std::runtime_error("No component registered for this type : " + component_name);
-            map[component_name](to, object);
+            for (auto &g : _groups) {
+                g->clear();
+                for (std::size_t e = 0; e < _signatures.size(); e++) {
+                    if (g->matches(_signatures[e]))
+                        g->insert(entity_from_index(e));
+                }
+            }
         }
 
+    // SORTING
+    public:
         /**
-         * @brief remove a component from an entity
+         * @brief Algorithm used by sort
          *
-         * @tparam Component type to remove
-         * @param from entity to remove the component from
          */
-        template <typename Component> void remove_component(entity const &from)
-        {
-            get_components<Component>().erase(from);
-        }
+        enum class sort_mode {
+            full, /**< std::sort, for components in any order */
+            insertion /**< insertion sort, linear on nearly sorted components, to keep an order from a frame to the next */
+        };
         /**
-         * @brief Get the max entity count of the registry
+         * @brief Sort the pool of a component in place, so iterating it (or a group containing it) follows the order.
+         * The pools owned by the same group as the component follow it; the entities of its owning group stay first and are
+         * sorted among themselves. The other groups containing the component are sorted too.
+         * The component must be stored in a packed_array.
+         * @code
+         * reg.sort<sprite>([](sprite const &a, sprite const &b) { return a.z < b.z; });
+         * // each frame after, the z only changes a little
+         * reg.sort<sprite>([](sprite const &a, sprite const &b) { return a.z < b.z; }, ecs::registry::sort_mode::insertion);
+         * @endcode
          *
-         * @return int max entity count
+         * @tparam Component pool to sort
+         * @tparam Compare bool(Component const &, Component const &)
+         * @param comp strict weak ordering of the components
+         * @param mode algorithm used
          */
-        int get_max_entity_count() const
+        template <class Component, class Compare> void sort(Compare comp, sort_mode mode = sort_mode::full)
         {
-            return _higgest_entity_id;
-        }
+            static_assert(std::is_same_v<storage_t<Component>, packed_array<Component>>, "sort needs a component stored in a packed_array");
+            auto &components = get_components<Component>();
+            std::size_t id = component_id<Component>();
+            auto owner = std::find_if(_groups.begin(), _groups.end(), [id](auto const &g) { return g->_owned && g->_mask.test(id); });
+            std::size_t split = owner == _groups.end() ? 0 : (*owner)->size();
 
-        /**
-         * @brief Check if an entity has a component
-         *
-         * @tparam Component to check
-         * @param e entity to check
-         * @return true or false
-         */
-        template <typename Component> bool has_component(entity const &e) const
-        {
-            try {
-                if (get_components<Component>().size() <= e) return false;
-                return get_components<Component>()[e].has_value();
-            } catch (std::exception) {
-                return false;
+            for (auto [first, last] : {std::make_pair(std::size_t(0), split), std::make_pair(split, components.live_count())}) {
+                if (mode == sort_mode::insertion)
+                    components.insertion_sort(comp, first, last);
+                else
+                    components.sort(comp, first, last);
+            }
+            for (auto &g : _groups) {
+                if (!g->_mask.test(id))
+                    continue;
+                std::size_t middle = g->follow(components, split);
+
+                if (!g->_owned && middle && middle < g->size())
+                    g->merge_runs(components, middle, comp);
             }
         }
 
@@ -202,71 +1745,248 @@ namespace ecs {
     private:
         class system {
             public:
-                system(std::function<void(registry &, std::vector<entity> &)> &&f, int priority = 0) : _f(f), _priority(priority) {}
+                system(std::function<void(registry &, std::vector<entity> &)> &&f, int priority = 0,
+                    std::vector<std::size_t> &&reads = {}, std::vector<std::size_t> &&writes = {}, bool exclusive = true, std::size_t owner = 0)
+                    : _f(f), _priority(priority), _reads(std::move(reads)), _writes(std::move(writes)), _exclusive(exclusive), _owner(owner) {}
                 int get_priority() const { return _priority; }
-                void operator()(registry &reg, std::vector<entity> &entities) { _f(reg, entities); }
+                std::size_t get_owner() const { return _owner; }
+                void operator()(registry &reg, std::vector<entity> &entities)
+                {
+#ifdef ECS_PROFILING
+                    profiler::clock::time_point start = profiler::clock::now();
+                    std::size_t iterated = detail::iterated_entities;
+
+                    _f(reg, entities);
+                    reg._profiler.record(_zone, start, detail::iterated_entities - iterated);
+#else
+                    _f(reg, entities);
+#endif
+                }
+#ifdef ECS_PROFILING
+                void set_profiling(std::size_t zone)
+                {
+                    _zone = zone;
+                }
+#endif
+                bool conflicts_with(system const &other) const
+                {
+                    return _exclusive || other._exclusive || intersects(_writes, other._writes)
+                        || intersects(_writes, other._reads) || intersects(_reads, other._writes);
+                }
             private:
+                static bool intersects(std::vector<std::size_t> const &a, std::vector<std::size_t> const &b)
+                {
+                    return std::any_of(a.begin(), a.end(), [&b](std::size_t id) {
+                        return std::find(b.begin(), b.end(), id) != b.end();
+                    });
+                }
                 std::function<void(registry &, std::vector<entity> &)> _f;
                 int _priority;
+                std::vector<std::size_t> _reads;
+                std::vector<std::size_t> _writes;
+                bool _exclusive;
+                std::size_t _owner; /**< module that added the system, 0 for the program */
+#ifdef ECS_PROFILING
+                std::size_t _zone = 0;
+#endif
         };
+        struct system_node {
+            std::size_t dependencies = 0;
+            std::vector<std::size_t> successors;
+        };
+        struct system_level {
+            std::size_t begin;
+            std::size_t end;
+            std::vector<system_node> nodes;
+        };
+
+        template <class Component> decltype(auto) system_argument()
+        {
+            if constexpr (std::is_const_v<Component>)
+                return std::as_const(get_components<std::remove_const_t<Component>>());
+            else
+                return get_components<Component>();
+        }
+
+        void build_schedule()
+        {
+            _schedule.clear();
+            for (std::size_t begin = 0; begin < _systems.size();) {
+                std::size_t end = begin;
+                system_level level{begin, begin, {}};
+
+                while (end < _systems.size() && _systems[end].get_priority() == _systems[begin].get_priority())
+                    end++;
+                level.end = end;
+                level.nodes.resize(end - begin);
+                for (std::size_t i = begin; i < end; i++) {
+                    for (std::size_t j = begin; j < i; j++) {
+                        if (_systems[j].conflicts_with(_systems[i])) {
+                            level.nodes[j - begin].successors.push_back(i - begin);
+                            level.nodes[i - begin].dependencies++;
+                        }
+                    }
+                }
+                _schedule.push_back(std::move(level));
+                begin = end;
+            }
+        }
+
+        void run_level(system_level const &level, std::vector<entity> &e)
+        {
+            std::size_t count = level.end - level.begin;
+            std::unique_ptr<std::atomic<std::size_t>[]> dependencies(new std::atomic<std::size_t>[count]);
+            std::atomic<std::size_t> remaining(count);
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            std::function<void(std::size_t)> run;
+            // remaining is decremented by the task once run returned, the waiter can return as soon as it reads 0
+            auto submit = [this, &run, &remaining](std::size_t i) {
+                _system_pool->submit([&run, &remaining, i]() {
+                    run(i);
+                    remaining--;
+                });
+            };
+
+            run = [&](std::size_t i) {
+                try {
+                    _systems[level.begin + i](*this, e);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                for (std::size_t next : level.nodes[i].successors) {
+                    if (--dependencies[next] == 0)
+                        submit(next);
+                }
+            };
+            for (std::size_t i = 0; i < count; i++)
+                dependencies[i] = level.nodes[i].dependencies;
+            for (std::size_t i = 0; i < count; i++) {
+                if (level.nodes[i].dependencies == 0)
+                    submit(i);
+            }
+            _system_pool->wait_until([&remaining]() { return remaining == 0; });
+            if (error)
+                std::rethrow_exception(error);
+        }
     public:
         /**
          * @brief add a system to the registry
          *
-         * @tparam Components
+         * @tparam Components the system uses, a const component is only read by the system and is given as a const container
          * @tparam Function
          * @param f the function to execute
          * @param priority the priority in which the system will be executed
          */
         template <class... Components, typename Function>
         void add_system(Function &&f, int priority=0) {
+            add_system<Components...>(std::string(), std::forward<Function>(f), priority);
+        }
+        /**
+         * @brief add a named system to the registry, the name is shown by the profiler (see ECS_PROFILING)
+         *
+         * @tparam Components the system uses, a const component is only read by the system and is given as a const container
+         * @tparam Function
+         * @param name of the system, "system <n>" if empty
+         * @param f the function to execute
+         * @param priority the priority in which the system will be executed
+         */
+        template <class... Components, typename Function>
+        void add_system(std::string const &name, Function &&f, int priority=0) {
+            std::vector<std::size_t> reads;
+            std::vector<std::size_t> writes;
+
+            ((std::is_const_v<Components> ? reads : writes).push_back(component_id<Components>()), ...);
             _systems.emplace_back(
-                [&f](registry &reg, std::vector<entity> &entities) {
-                    f(reg, entities, reg.get_components<Components>()...);
+                [f = std::forward<Function>(f)](registry &reg, std::vector<entity> &entities) mutable {
+                    f(reg, entities, reg.system_argument<Components>()...);
                 },
-                priority
+                priority, std::move(reads), std::move(writes), sizeof...(Components) == 0, _loading_module
             );
-            std::sort(_systems.begin(), _systems.end(), [](const system &a, const system &b) {
+#ifdef ECS_PROFILING
+            _systems.back().set_profiling(_profiler.add_zone(name.empty() ? "system " + std::to_string(_systems.size() - 1) : name, "system"));
+#else
+            (void)name;
+#endif
+            std::stable_sort(_systems.begin(), _systems.end(), [](const system &a, const system &b) {
                 return a.get_priority() < b.get_priority();
             });
+            build_schedule();
+        }
+
+        /**
+         * @brief Run the systems of a same priority in parallel. Two systems run at the same time only if none of them
+         * writes a component the other uses, otherwise they keep the order in which they were added.
+         * A system without components is never run with another one. Systems run in parallel must only use the
+         * components given to them and must not spawn or kill entities.
+         *
+         * @param workers number of threads running the systems, 0 runs them one after the other
+         */
+        void set_parallel_systems(std::size_t workers)
+        {
+            _system_pool = workers ? std::make_unique<thread_pool>(workers) : nullptr;
+            while (_command_buffers.size() < workers + 1)
+                _command_buffers.push_back(std::make_unique<command_buffer>(*this));
         }
 
         /**
-         * @brief run all the systems
+         * @brief run all the systems at a new tick, after merging the staged operations, applying the command buffers after each priority level, then dispatch the queued events
          * @param e a vector of entities to pass to the systems, it is useful for systems that need to access other entities, to manage a scene for example
          */
         void run_systems(std::vector<entity> &e)
         {
-            for (auto &f : _systems) {
-                f(*this, e);
+#ifdef ECS_PROFILING
+            profiler::clock::time_point start = profiler::clock::now();
+#endif
+            _tick++;
+            for (auto p : _tracked_pools)
+                p->set_tick(_tick);
+            merge_staged();
+            for (auto const &level : _schedule) {
+                if (!_system_pool) {
+                    for (std::size_t i = level.begin; i < level.end; i++)
+                        _systems[i](*this, e);
+                } else {
+                    run_level(level, e);
+                }
+                flush_commands();
             }
+            flush_events(e);
+#ifdef ECS_PROFILING
+            _profiler.record(_frame_zone, start, e.size());
+            _profiler.end_frame();
+#endif
         }
+#ifdef ECS_PROFILING
+        /**
+         * @brief Get the profiler measuring the systems and the event handlers, only available when ECS_PROFILING is defined.
+         * Each run_systems is a frame of the profiler.
+         *
+         * @return profiler&
+         */
+        profiler &get_profiler()
+        {
+            return _profiler;
+        }
+#endif
         // MODULE/lib
         using entrypoint_fcn = void (*)(ecs::registry &);
+        using dependencies_fcn = const char *(*)();
 
         /**
             @brief: Load a library and execute the entrypoint function
             @param lib_name: The name of the library to load
-            @param reg: The registry to pass to the entrypoint function
             @param function_name: The name of the entrypoint function, default is "entrypoint"
         */
         void lib_entrypoint(const std::string &lib_name, const std::string &function_name="entrypoint")
         {
-            auto handle = load_lib(lib_name);
-            if (!handle) {
-                return;
-            }
-            try {
-                auto entrypoint = get_function<entrypoint_fcn>(function_name, handle);
-                entrypoint(*this);
-            } catch (const std::exception &e) {
-                std::cerr << "Error while executing lib_entrypoint: " << e.what() << std::endl;
-                close_lib(handle);
-            }
+            load_modules({lib_name}, function_name);
         }
-        
+
         /**
-            @brief: Load all the libraries in a folder and execute the entrypoint function
+            @brief: Load all the libraries in a folder and execute the entrypoint function, see load_modules
             @param folder_path: The path of the folder to load all the libraries in it
         */
        void all_libs_entrypoint(const std::string &folder_path)
@@ -281,6 +2001,8 @@ namespace ecs {
                 return;
             }
 
+            std::vector<std::string> paths;
+
             for (const auto &entry : std::filesystem::directory_iterator(folder_path)) {
                 if (entry.is_directory()) {
                         // all_libs_entrypoint(entry.path().string());
@@ -290,23 +2012,206 @@ namespace ecs {
 #else
                     if (entry.path().extension() == ".so") {
 #endif
-                        lib_entrypoint(entry.path().string());
+                        paths.push_back(entry.path().string());
                     }
                 }
             }
+            std::sort(paths.begin(), paths.end());
+            load_modules(paths);
        }
 
-        bool add_lib(const std::string &lib_name)
+        /**
+            @brief: Load libraries and execute their entrypoint. The libraries are opened in parallel, then the entrypoints
+            run one after the other on the calling thread, in the order of the paths. A module exporting
+            `const char *dependencies()`, returning the names of other modules (file names without extension, separated by
+            spaces), runs after them. The libraries already loaded are skipped.
+            @param lib_paths: The paths of the libraries to load
+            @param function_name: The name of the entrypoint function, default is "entrypoint"
+        */
+        void load_modules(const std::vector<std::string> &lib_paths, const std::string &function_name="entrypoint")
+        {
+            std::vector<std::string> paths;
+            std::vector<std::future<void *>> opening;
+            std::vector<std::pair<std::string, void *>> opened;
+
+            for (auto const &lib_path : lib_paths) {
+                std::string key = module_key(lib_path);
+
+                if (_modules.find(key) == _modules.end() && std::find(paths.begin(), paths.end(), key) == paths.end())
+                    paths.push_back(key);
+            }
+            for (auto const &path : paths)
+                opening.push_back(std::async(std::launch::async, [this, &path]() { return load_lib(path); }));
+            for (std::size_t i = 0; i < paths.size(); i++) {
+                if (void *handle = opening[i].get())
+                    opened.emplace_back(paths[i], handle);
+            }
+            for (std::size_t i : entrypoint_order(opened))
+                run_module(opened[i].first, opened[i].second, function_name);
+        }
+
+        /**
+            @brief: Reload a module without touching the entities and the components: its systems and event handlers are
+            removed, then the entrypoint of the new version of the library runs again. Registering an existing component
+            keeps its container while reloading. The previous version of the library stays open until the registry is
+            destroyed, as the components and closures it created may still use its code.
+            @param lib_path: The path of the library, as given when it was loaded
+            @param function_name: The name of the entrypoint function, default is "entrypoint"
+            @return true if the module was reloaded
+        */
+        bool reload_module(const std::string &lib_path, const std::string &function_name="entrypoint")
+        {
+            auto it = _modules.find(module_key(lib_path));
+
+            if (it == _modules.end()) {
+                std::cerr << "Cannot reload " << lib_path << ": module not loaded" << std::endl;
+                return false;
+            }
+            // the loader returns the library already open for a same file, so open a copy of the new version
+            std::filesystem::path source(it->first);
+            std::filesystem::path copy = std::filesystem::temp_directory_path()
+                / (source.stem().string() + ".reload" + std::to_string(++_module_reloads) + source.extension().string());
+            std::error_code error;
+
+            std::filesystem::copy_file(source, copy, std::filesystem::copy_options::overwrite_existing, error);
+            if (error) {
+                std::cerr << "Cannot reload " << lib_path << ": " << error.message() << std::endl;
+                return false;
+            }
+            void *handle = load_lib(copy.string());
+            std::filesystem::remove(copy, error);
+            if (!handle)
+                return false;
+            auto entrypoint = find_function<entrypoint_fcn>(function_name, handle);
+            if (!entrypoint) {
+                std::cerr << "Cannot reload " << lib_path << ": no " << function_name << " function" << std::endl;
+                close_lib(handle);
+                return false;
+            }
+            remove_module_content(it->second.id);
+            it->second.handle = handle;
+            _libraries.handles.push_back(handle);
+            _reloading = true;
+            run_entrypoint(it->second, entrypoint);
+            _reloading = false;
+            return true;
+        }
+
+        /**
+            @brief: Remove the systems and the event handlers added by a module. Its library stays open until the registry
+            is destroyed, and the components it registered stay.
+            @param lib_path: The path of the library, as given when it was loaded
+            @return true if the module was loaded
+        */
+        bool unload_module(const std::string &lib_path)
         {
-            if (is_lib_loaded(lib_name)) return false;
-            _loaded_libs.push_back(lib_name);
+            auto it = _modules.find(module_key(lib_path));
+
+            if (it == _modules.end())
+                return false;
+            remove_module_content(it->second.id);
+            _modules.erase(it);
             return true;
         }
+
+        bool add_lib(const std::string &lib_name)
+        {
+            return _loaded_libs.insert(lib_name).second;
+        }
         bool is_lib_loaded(const std::string &lib_name)
         {
-            return std::find(_loaded_libs.begin(), _loaded_libs.end(), lib_name) != _loaded_libs.end();
+            return _loaded_libs.find(lib_name) != _loaded_libs.end();
         }
     private:
+        struct loaded_module {
+            std::size_t id;
+            void *handle;
+        };
+        struct library_set {
+            library_set() = default;
+            library_set(library_set const &) = delete;
+            library_set &operator=(library_set const &) = delete;
+            ~library_set()
+            {
+                for (void *handle : handles)
+                    close_lib(handle);
+            }
+            std::vector<void *> handles;
+        };
+
+        static std::string module_key(const std::string &lib_path)
+        {
+            return std::filesystem::absolute(lib_path).lexically_normal().string();
+        }
+        std::vector<std::size_t> entrypoint_order(std::vector<std::pair<std::string, void *>> const &opened)
+        {
+            std::vector<std::string> names;
+            std::vector<std::vector<std::size_t>> dependencies(opened.size());
+            std::vector<std::size_t> order;
+            std::vector<bool> placed(opened.size(), false);
+
+            for (auto const &lib : opened)
+                names.push_back(std::filesystem::path(lib.first).stem().string());
+            for (std::size_t i = 0; i < opened.size(); i++) {
+                auto list = find_function<dependencies_fcn>("dependencies", opened[i].second);
+                std::istringstream stream(list ? list() : "");
+
+                for (std::string name; stream >> name;) {
+                    auto found = std::find(names.begin(), names.end(), name);
+
+                    if (found != names.end())
+                        dependencies[i].push_back(found - names.begin());
+                    else if (std::none_of(_modules.begin(), _modules.end(), [&name](auto const &m) { return std::filesystem::path(m.first).stem() == name; }))
+                        std::cerr << "Module " << names[i] << " depends on " << name << " which is not loaded" << std::endl;
+                }
+            }
+            while (order.size() < opened.size()) {
+                std::size_t next = opened.size();
+
+                for (std::size_t i = 0; i < opened.size() && next == opened.size(); i++) {
+                    if (!placed[i] && std::all_of(dependencies[i].begin(), dependencies[i].end(), [&placed](std::size_t d) { return placed[d]; }))
+                        next = i;
+                }
+                if (next == opened.size()) {
+                    next = std::find(placed.begin(), placed.end(), false) - placed.begin();
+                    std::cerr << "Module " << names[next] << " is in a dependency cycle, its entrypoint runs before some of its dependencies" << std::endl;
+                }
+                placed[next] = true;
+                order.push_back(next);
+            }
+            return order;
+        }
+        void run_module(std::string const &path, void *handle, const std::string &function_name)
+        {
+            entrypoint_fcn entrypoint = nullptr;
+
+            try {
+                entrypoint = get_function<entrypoint_fcn>(function_name, handle);
+            } catch (const std::exception &e) {
+                std::cerr << "Error while executing lib_entrypoint: " << e.what() << std::endl;
+                close_lib(handle);
+                return;
+            }
+            _libraries.handles.push_back(handle);
+            run_entrypoint(_modules.emplace(path, loaded_module{++_module_count, handle}).first->second, entrypoint);
+        }
+        void run_entrypoint(loaded_module const &m, entrypoint_fcn entrypoint)
+        {
+            _loading_module = m.id;
+            try {
+                entrypoint(*this);
+            } catch (const std::exception &e) {
+                std::cerr << "Error while executing lib_entrypoint: " << e.what() << std::endl;
+            }
+            _loading_module = 0;
+        }
+        void remove_module_content(std::size_t id)
+        {
+            _systems.erase(std::remove_if(_systems.begin(), _systems.end(), [id](system const &s) { return s.get_owner() == id; }), _systems.end());
+            build_schedule();
+            for (auto &event : _events)
+                event.second->remove_handlers(id);
+        }
         void *load_lib(const std::string &lib_path) {
             if (!std::filesystem::exists(lib_path)) {
                 std::cerr << "Cannot find library: " << lib_path << std::endl;
@@ -338,7 +2243,7 @@ namespace ecs {
             return handle;
         }
 
-        void close_lib(void *handle)
+        static void close_lib(void *handle)
         {
             if (handle) {
 #ifdef _WIN32
@@ -350,14 +2255,18 @@ namespace ecs {
         }
 
         template <typename T>
-        T get_function(const std::string &function_name, void *handle)
+        T find_function(const std::string &function_name, void *handle)
         {
-            T function = nullptr;
 #ifdef _WIN32
-            function = (T)GetProcAddress((HMODULE)handle, function_name.c_str());
+            return (T)GetProcAddress((HMODULE)handle, function_name.c_str());
 #else
-            function = (T)dlsym(handle, function_name.c_str());
+            return (T)dlsym(handle, function_name.c_str());
 #endif
+        }
+        template <typename T>
+        T get_function(const std::string &function_name, void *handle)
+        {
+            T function = find_function<T>(function_name, handle);
 
             if (!function) {
                 std::string error_message;
@@ -386,32 +2295,110 @@ namespace ecs {
             return _state;
         }
 
+        /**
+         * @brief Get the channel of an event, created if it does not exist. Keep the reference to trigger the event without looking up its name.
+         * Throws a std::runtime_error if the event exists with other parameters.
+         *
+         * @tparam Args parameters of the event
+         * @param event_name name of the event
+         * @return event_channel<Args...>&
+         */
+        template<typename... Args>
+        event_channel<Args...> &get_event(const std::string &event_name)
+        {
+            auto it = _events.find(event_name);
+
+            if (it == _events.end()) {
+                it = _events.emplace(event_name, std::make_unique<event_channel<Args...>>()).first;
+                _events_order.push_back(it->second.get());
+                it->second->set_owner(_loading_module);
+#ifdef ECS_PROFILING
+                it->second->set_profiler(_profiler, event_name);
+#endif
+            }
+            auto channel = dynamic_cast<event_channel<Args...> *>(it->second.get());
+            if (!channel)
+                throw std::runtime_error("Event " + event_name + " registered with other parameters");
+            return *channel;
+        }
+
+        /**
+         * @brief Add a handler to an event
+         *
+         * @tparam Args parameters of the event
+         * @tparam Function
+         * @param event_name name of the event
+         * @param f handler, called with the registry, the entity vector and the parameters of the event
+         */
         template<typename... Args, typename Function>
         void add_event(const std::string &event_name, Function &&f)
         {
-            _events[event_name].emplace_back(std::function<void(registry &, std::vector<entity> &enitiesn, Args...)>(f));
+            get_event<Args...>(event_name).subscribe(std::forward<Function>(f));
         }
 
+        /**
+         * @brief Trigger an event, its handlers are called immediately
+         *
+         * @tparam Args parameters of the event, decayed like when they were taken by value (a string literal is a const char *)
+         * @param event_name name of the event
+         * @param entities given to the handlers
+         * @param args parameters of the event
+         */
         template<typename... Args>
-        void trigger_event(const std::string &event_name, std::vector<entity> &entities, Args... args)
+        void trigger_event(const std::string &event_name, std::vector<entity> &entities, Args const &...args)
         {
-            for (auto &f : _events[event_name]) {
-                std::any_cast<std::function<void(registry &, std::vector<entity> &, Args...)>>(f)(*this, entities, args...);
-            }
+            get_event<std::decay_t<Args const &>...>(event_name).trigger(*this, entities, args...);
+        }
+
+        /**
+         * @brief Dispatch the events queued in all the channels, in the order the channels were created. Called at the end of run_systems.
+         *
+         * @param entities given to the handlers
+         */
+        void flush_events(std::vector<entity> &entities)
+        {
+            for (auto channel : _events_order)
+                channel->flush(*this, entities);
         }
 
     private:
-        std::unordered_map<std::type_index, std::any> _components_array;
+        static constexpr std::uint32_t snapshot_magic = 0x33534345; /**< "ECS3" */
+        static constexpr std::uint32_t delta_magic = 0x44534345; /**< "ECSD" */
+
+        library_set _libraries; /**< first member, so the libraries are closed after everything their code created */
+        staged_list _staged;
+        std::vector<std::unique_ptr<pool_base>> _components_array;
+        std::vector<pool_base *> _tracked_pools;
+        tick_t _tick = 1;
         std::unordered_map<std::string, std::function<void(entity const &, std::any)>> _components_adder;
-        int _higgest_entity_id = 0;
-        std::vector<size_t> _available_ids;
-        std::vector<std::function<void(registry &, entity const &)>>
-            _remove_component_functions;
+        entity_allocator _ids;
+
+        static_assert((std::size_t(1) << entity::index_bits) <= entity_allocator::max_recycled, "ECS_ENTITY_INDEX_BITS is too large to recycle every index");
+        std::vector<signature> _signatures;
+        std::vector<std::unique_ptr<group_base>> _groups;
+        signature _owned_components;
+        archetype_storage _archetypes;
+        signature _archetype_components;
         std::vector<system> _systems;
+        std::vector<system_level> _schedule;
+        std::unique_ptr<thread_pool> _system_pool;
+        std::vector<std::unique_ptr<command_buffer>> _command_buffers;
         std::unordered_map<std::type_index, std::any> _components_from_type;
+        std::unordered_map<std::type_index, std::shared_ptr<void>> _resources;
         std::string _state;
-        std::vector<std::string> _loaded_libs;
-        std::unordered_map<std::string, std::vector<std::any>> _events;
+        std::unordered_set<std::string> _loaded_libs;
+        std::unordered_map<std::string, loaded_module> _modules;
+        std::size_t _module_count = 0;
+        std::size_t _module_reloads = 0;
+        std::size_t _loading_module = 0; /**< module whose entrypoint is running, 0 outside of them */
+        bool _reloading = false;
+        std::atomic<std::size_t> const *_component_id_counter = &detail::component_id_counter(); /**< counter of the program that created the registry */
+        std::unordered_map<std::string, std::unique_ptr<event_channel_base>> _events;
+        std::vector<event_channel_base *> _events_order;
+#ifdef ECS_PROFILING
+        profiler _profiler;
+        std::size_t _frame_zone = _profiler.add_zone("run_systems", "frame");
+#endif
     };
 }
 
@@ -0,0 +1,120 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Registry_stats
+*/
+
+#ifndef REGISTRY_STATS_HPP_
+#define REGISTRY_STATS_HPP_
+
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __GNUG__
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+#include "Json.hpp"
+
+namespace ecs {
+    /**
+     * @brief Get the readable name of a type from the name given by typeid. Only GCC and Clang mangle it, other compilers
+     * already give a readable name.
+     *
+     * @param name of the type, from typeid(T).name()
+     * @return std::string
+     */
+    inline std::string demangle(char const *name)
+    {
+#ifdef __GNUG__
+        int status = 0;
+        char *readable = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+
+        if (status == 0 && readable) {
+            std::string result(readable);
+
+            std::free(readable);
+            return result;
+        }
+        std::free(readable);
+#endif
+        return name;
+    }
+
+    /**
+     * @brief Memory and occupancy of the pool of a component type
+     *
+     */
+    struct pool_stats {
+        std::string name; /**< name of the component type, demangled */
+        std::string storage; /**< sparse_array, packed_array, soa_array or archetype_storage */
+        std::size_t slots = 0; /**< components the allocated memory can hold */
+        std::size_t live = 0; /**< components stored */
+        std::size_t bytes = 0; /**< bytes allocated, indexes included */
+        double occupancy = 0; /**< live / slots, 0 when nothing is allocated */
+        std::size_t resizes = 0; /**< times the storage grew since the last reset_stats */
+    };
+
+    /**
+     * @brief Memory and occupancy of the pools and the entities of a registry, returned by registry::stats
+     *
+     */
+    struct registry_stats {
+        std::vector<pool_stats> pools; /**< in the order of the component ids */
+        std::size_t entities = 0; /**< ids given since the beginning, the highest id plus one */
+        std::size_t alive = 0; /**< entities not killed */
+        std::size_t free_ids = 0; /**< killed ids waiting to be reused */
+        std::size_t bytes = 0; /**< bytes allocated by all the pools */
+
+        /**
+         * @brief Write the statistics as a JSON object
+         *
+         * @param out stream to write to
+         */
+        void write_json(std::ostream &out) const
+        {
+            out << "{\n  \"entities\": " << entities << ",\n  \"alive\": " << alive << ",\n  \"free_ids\": " << free_ids
+                << ",\n  \"bytes\": " << bytes << ",\n  \"pools\": [";
+            for (std::size_t i = 0; i < pools.size(); i++) {
+                pool_stats const &p = pools[i];
+
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << detail::json_escape(p.name) << "\", \"storage\": \"" << p.storage << "\", \"slots\": " << p.slots
+                    << ", \"live\": " << p.live << ", \"bytes\": " << p.bytes << ", \"occupancy\": " << p.occupancy << ", \"resizes\": " << p.resizes << "}";
+            }
+            out << "\n  ]\n}\n";
+        }
+        /**
+         * @brief Get the statistics as a JSON object
+         *
+         * @return std::string
+         */
+        std::string to_json() const
+        {
+            std::ostringstream out;
+
+            write_json(out);
+            return out.str();
+        }
+        /**
+         * @brief Write the statistics in a JSON file
+         *
+         * @param path of the file
+         * @return true if the file was written
+         */
+        bool save_json(std::string const &path) const
+        {
+            std::ofstream out(path);
+
+            if (!out)
+                return false;
+            write_json(out);
+            return static_cast<bool>(out);
+        }
+    };
+}
+
+#endif /* !REGISTRY_STATS_HPP_ */
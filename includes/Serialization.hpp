@@ -0,0 +1,496 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Serialization
+*/
+
+#ifndef SERIALIZATION_HPP_
+#define SERIALIZATION_HPP_
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+namespace ecs {
+    namespace detail {
+        /**
+         * @brief Check if the integers of the target are stored little-endian, the byte order of the binary data.
+         * Other targets convert the integers one by one.
+         *
+         */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+        inline constexpr bool little_endian = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+#elif defined(_WIN32)
+        inline constexpr bool little_endian = true;
+#else
+        inline constexpr bool little_endian = false;
+#endif
+    }
+
+    /**
+     * @brief Append binary data to a buffer. The integers of the format (sizes, indexes, signatures) have a fixed width
+     * and are stored little-endian, so the data can be read on another compiler or architecture; trivially copyable
+     * components are copied as their bytes, they need the same layout on both sides.
+     *
+     */
+    class binary_writer {
+    public:
+        /**
+         * @brief Construct a new binary writer object
+         *
+         * @param buffer to append to
+         */
+        explicit binary_writer(std::vector<std::byte> &buffer) : _buffer(buffer) {}
+
+        /**
+         * @brief Append raw bytes
+         *
+         * @param data to copy
+         * @param size number of bytes
+         */
+        void write_bytes(void const *data, std::size_t size)
+        {
+            std::byte const *bytes = static_cast<std::byte const *>(data);
+
+            _buffer.insert(_buffer.end(), bytes, bytes + size);
+        }
+        /**
+         * @brief Append a trivially copyable value
+         *
+         * @tparam T
+         * @param value to copy
+         */
+        template <typename T> void write(T const &value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written directly");
+            write_bytes(&value, sizeof(T));
+        }
+        /**
+         * @brief Append an unsigned integer on sizeof(Wire) bytes, little-endian
+         *
+         * @tparam Wire std::uint8_t, std::uint16_t, std::uint32_t or std::uint64_t
+         * @param value to write, must fit in Wire
+         */
+        template <typename Wire> void write_uint(Wire value)
+        {
+            static_assert(std::is_unsigned_v<Wire>, "Only unsigned integers have a fixed binary format");
+            std::byte bytes[sizeof(Wire)];
+
+            for (std::size_t i = 0; i < sizeof(Wire); i++)
+                bytes[i] = static_cast<std::byte>((value >> (8 * i)) & 0xFF);
+            write_bytes(bytes, sizeof(Wire));
+        }
+        /**
+         * @brief Append an array of unsigned integers, each on sizeof(Wire) bytes, little-endian.
+         * Copied in bulk when the integers already have this format.
+         *
+         * @tparam Wire width of the integers in the data
+         * @tparam T type of the integers in memory
+         * @param data integers to write
+         * @param count number of integers
+         */
+        template <typename Wire, typename T> void write_uints(T const *data, std::size_t count)
+        {
+            static_assert(std::is_unsigned_v<T>, "Only unsigned integers have a fixed binary format");
+            if constexpr (sizeof(T) == sizeof(Wire) && detail::little_endian) {
+                write_bytes(data, count * sizeof(T));
+            } else {
+                reserve(count * sizeof(Wire));
+                for (std::size_t i = 0; i < count; i++)
+                    write_uint<Wire>(static_cast<Wire>(data[i]));
+            }
+        }
+        /**
+         * @brief Append a size, always stored on 64 bits
+         *
+         * @param size
+         */
+        void write_size(std::size_t size)
+        {
+            write_uint<std::uint64_t>(size);
+        }
+        /**
+         * @brief Append a set of bits: its number of bits on 32 bits, then the bits, 8 per byte, the first bit in the lowest one
+         *
+         * @tparam N number of bits
+         * @param bits to write
+         */
+        template <std::size_t N> void write_bits(std::bitset<N> const &bits)
+        {
+            std::byte bytes[sizeof(std::uint32_t) + (N + 7) / 8]{};
+
+            for (std::size_t i = 0; i < sizeof(std::uint32_t); i++)
+                bytes[i] = static_cast<std::byte>((N >> (8 * i)) & 0xFF);
+            if constexpr (N <= 64) {
+                // a single word, its bytes are taken at once
+                unsigned long long word = bits.to_ullong();
+
+                for (std::size_t i = 0; i < (N + 7) / 8; i++)
+                    bytes[sizeof(std::uint32_t) + i] = static_cast<std::byte>((word >> (8 * i)) & 0xFF);
+            } else {
+                for (std::size_t i = 0; i < N; i++) {
+                    if (bits.test(i))
+                        bytes[sizeof(std::uint32_t) + i / 8] |= static_cast<std::byte>(1 << (i % 8));
+                }
+            }
+            write_bytes(bytes, sizeof(bytes));
+        }
+        /**
+         * @brief Append a string, its size then its characters
+         *
+         * @param str
+         */
+        void write_string(std::string const &str)
+        {
+            write_size(str.size());
+            write_bytes(str.data(), str.size());
+        }
+        /**
+         * @brief Reserve room for more bytes
+         *
+         * @param size number of bytes about to be written
+         */
+        void reserve(std::size_t size)
+        {
+            _buffer.reserve(_buffer.size() + size);
+        }
+        /**
+         * @brief Append bytes to fill in place
+         *
+         * @param size number of bytes
+         * @return std::byte* first byte appended
+         */
+        std::byte *extend(std::size_t size)
+        {
+            _buffer.resize(_buffer.size() + size);
+            return _buffer.data() + _buffer.size() - size;
+        }
+
+    private:
+        std::vector<std::byte> &_buffer;
+    };
+
+    /**
+     * @brief Read binary data written by a binary_writer. Throws a std::runtime_error when reading past the end.
+     *
+     */
+    class binary_reader {
+    public:
+        /**
+         * @brief Construct a new binary reader object
+         *
+         * @param data to read
+         * @param size number of bytes
+         */
+        binary_reader(std::byte const *data, std::size_t size) : _data(data), _size(size) {}
+        /**
+         * @brief Construct a new binary reader object
+         *
+         * @param buffer to read
+         */
+        explicit binary_reader(std::vector<std::byte> const &buffer) : _data(buffer.data()), _size(buffer.size()) {}
+
+        /**
+         * @brief Copy raw bytes
+         *
+         * @param data destination
+         * @param size number of bytes
+         */
+        void read_bytes(void *data, std::size_t size)
+        {
+            if (!size)
+                return;
+            if (size > _size - _pos)
+                throw std::runtime_error("Binary data too short");
+            std::memcpy(data, _data + _pos, size);
+            _pos += size;
+        }
+        /**
+         * @brief Get the next bytes without copying them, then move past them
+         *
+         * @param size number of bytes
+         * @return std::byte const* first byte
+         */
+        std::byte const *skip(std::size_t size)
+        {
+            if (size > _size - _pos)
+                throw std::runtime_error("Binary data too short");
+            std::byte const *bytes = _data + _pos;
+
+            _pos += size;
+            return bytes;
+        }
+        /**
+         * @brief Read a trivially copyable value
+         *
+         * @tparam T
+         * @return T
+         */
+        template <typename T> T read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read directly");
+            T value;
+
+            read_bytes(&value, sizeof(T));
+            return value;
+        }
+        /**
+         * @brief Read an unsigned integer written by write_uint
+         *
+         * @tparam Wire width of the integer in the data
+         * @return Wire
+         */
+        template <typename Wire> Wire read_uint()
+        {
+            static_assert(std::is_unsigned_v<Wire>, "Only unsigned integers have a fixed binary format");
+            std::byte bytes[sizeof(Wire)];
+            Wire value = 0;
+
+            read_bytes(bytes, sizeof(Wire));
+            for (std::size_t i = 0; i < sizeof(Wire); i++)
+                value |= static_cast<Wire>(static_cast<Wire>(bytes[i]) << (8 * i));
+            return value;
+        }
+        /**
+         * @brief Read an array of unsigned integers written by write_uints.
+         * Throws a std::runtime_error if an integer does not fit in T.
+         *
+         * @tparam Wire width of the integers in the data
+         * @tparam T type of the integers in memory
+         * @param data destination
+         * @param count number of integers
+         */
+        template <typename Wire, typename T> void read_uints(T *data, std::size_t count)
+        {
+            static_assert(std::is_unsigned_v<T>, "Only unsigned integers have a fixed binary format");
+            if constexpr (sizeof(T) == sizeof(Wire) && detail::little_endian) {
+                if (count > (_size - _pos) / sizeof(T))
+                    throw std::runtime_error("Binary data too short");
+                read_bytes(data, count * sizeof(T));
+            } else {
+                for (std::size_t i = 0; i < count; i++)
+                    data[i] = narrow<T>(read_uint<Wire>());
+            }
+        }
+        /**
+         * @brief Read a size written by write_size. Throws a std::runtime_error if it does not fit in a std::size_t.
+         *
+         * @return std::size_t
+         */
+        std::size_t read_size()
+        {
+            return narrow<std::size_t>(read_uint<std::uint64_t>());
+        }
+        /**
+         * @brief Read a set of bits written by write_bits, whatever its number of bits
+         *
+         * @tparam Function void(std::size_t bit)
+         * @param f called with the index of each set bit, in increasing order
+         * @return std::size_t number of bits of the set
+         */
+        template <typename Function> std::size_t for_each_bit(Function &&f)
+        {
+            std::size_t count = read_uint<std::uint32_t>();
+            std::byte const *bytes = skip((count + 7) / 8);
+
+            for (std::size_t byte = 0; byte < (count + 7) / 8; byte++) {
+                std::uint8_t value = static_cast<std::uint8_t>(bytes[byte]);
+
+                for (std::size_t i = 0; value && i < 8 && byte * 8 + i < count; i++) {
+                    if (value & (1 << i))
+                        f(byte * 8 + i);
+                }
+            }
+            return count;
+        }
+        /**
+         * @brief Read a set of bits written by write_bits. Missing bits are cleared; throws a std::runtime_error if a bit
+         * above N is set.
+         *
+         * @tparam N number of bits
+         * @return std::bitset<N>
+         */
+        template <std::size_t N> std::bitset<N> read_bits()
+        {
+            std::bitset<N> bits;
+
+            for_each_bit([&bits](std::size_t bit) {
+                if (bit >= N)
+                    throw std::runtime_error("Binary data has more bits than the set");
+                bits.set(bit);
+            });
+            return bits;
+        }
+        /**
+         * @brief Read a string written by write_string
+         *
+         * @return std::string
+         */
+        std::string read_string()
+        {
+            std::string str(read_size(), '\0');
+
+            read_bytes(str.data(), str.size());
+            return str;
+        }
+        /**
+         * @brief Check if all the data was read
+         *
+         * @return true if there is nothing left
+         */
+        bool done() const
+        {
+            return _pos == _size;
+        }
+
+    private:
+        template <typename T, typename Wire> static T narrow(Wire value)
+        {
+            if constexpr (sizeof(T) < sizeof(Wire)) {
+                if (value > std::numeric_limits<T>::max())
+                    throw std::runtime_error("Binary data has an integer too large for this build");
+            }
+            return static_cast<T>(value);
+        }
+
+        std::byte const *_data;
+        std::size_t _size;
+        std::size_t _pos = 0;
+    };
+
+    /**
+     * @brief Serializer of a component that is not trivially copyable, specialize it to snapshot the component:
+     * @code
+     * template <> struct ecs::serializer<name> {
+     *     static void write(ecs::binary_writer &writer, name const &n) { writer.write_string(n.value); }
+     *     static name read(ecs::binary_reader &reader) { return name{reader.read_string()}; }
+     * };
+     * @endcode
+     * Trivially copyable components do not need one, they are copied in bulk.
+     *
+     * @tparam Component
+     */
+    template <class Component> struct serializer;
+
+    namespace detail {
+        template <class Component, class = void> struct has_serializer : std::false_type {};
+        template <class Component>
+        struct has_serializer<Component, std::void_t<decltype(serializer<Component>::read(std::declval<binary_reader &>()))>> : std::true_type {};
+    }
+
+    /**
+     * @brief Check if a component has a specialized serializer
+     *
+     * @tparam Component
+     */
+    template <class Component> inline constexpr bool has_serializer_v = detail::has_serializer<Component>::value;
+
+    /**
+     * @brief Check if a component can be written in a snapshot, either copied in bulk or with its serializer
+     *
+     * @tparam Component
+     */
+    template <class Component> inline constexpr bool is_serializable_v = std::is_trivially_copyable_v<Component> || has_serializer_v<Component>;
+
+    /**
+     * @brief Write contiguous components, in bulk if they are trivially copyable, otherwise with their serializer
+     *
+     * @tparam Component
+     * @param writer
+     * @param data components to write
+     * @param count number of components
+     */
+    template <class Component> void write_components(binary_writer &writer, Component const *data, std::size_t count)
+    {
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            writer.write_bytes(data, count * sizeof(Component));
+        } else if constexpr (has_serializer_v<Component>) {
+            for (std::size_t i = 0; i < count; i++)
+                serializer<Component>::write(writer, data[i]);
+        } else {
+            (void)writer;
+            (void)data;
+            if (count)
+                throw std::runtime_error(std::string("Component is not serializable, specialize ecs::serializer : ") + typeid(Component).name());
+        }
+    }
+
+    /**
+     * @brief Write the components of consecutive optionals that all hold one, like write_components: trivially copyable
+     * components are copied in a single growth of the buffer
+     *
+     * @tparam Component
+     * @param writer
+     * @param slots optionals holding the components to write
+     * @param count number of optionals
+     */
+    template <class Component> void write_slots(binary_writer &writer, std::optional<Component> const *slots, std::size_t count)
+    {
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            std::byte *out = writer.extend(count * sizeof(Component));
+
+            for (std::size_t i = 0; i < count; i++)
+                std::memcpy(out + i * sizeof(Component), std::addressof(*slots[i]), sizeof(Component));
+        } else {
+            for (std::size_t i = 0; i < count; i++)
+                write_components(writer, std::addressof(*slots[i]), 1);
+        }
+    }
+
+    /**
+     * @brief Read one component written by write_components
+     *
+     * @tparam Component
+     * @param reader
+     * @return Component
+     */
+    template <class Component> Component read_component(binary_reader &reader)
+    {
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            return reader.read<Component>();
+        } else if constexpr (has_serializer_v<Component>) {
+            return serializer<Component>::read(reader);
+        } else {
+            (void)reader;
+            throw std::runtime_error(std::string("Component is not serializable, specialize ecs::serializer : ") + typeid(Component).name());
+        }
+    }
+
+    /**
+     * @brief Read components written by write_components or write_slots in consecutive empty optionals.
+     * Trivially copyable components are checked against the size of the data once.
+     *
+     * @tparam Component
+     * @param reader
+     * @param slots optionals to fill
+     * @param count number of components
+     */
+    template <class Component> void read_slots(binary_reader &reader, std::optional<Component> *slots, std::size_t count)
+    {
+        if constexpr (std::is_trivially_copyable_v<Component>) {
+            std::byte const *in = reader.skip(count * sizeof(Component));
+
+            for (std::size_t i = 0; i < count; i++) {
+                Component component;
+
+                std::memcpy(&component, in + i * sizeof(Component), sizeof(Component));
+                slots[i].emplace(component);
+            }
+        } else {
+            for (std::size_t i = 0; i < count; i++)
+                slots[i].emplace(read_component<Component>(reader));
+        }
+    }
+}
+
+#endif /* !SERIALIZATION_HPP_ */
@@ -0,0 +1,585 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Soa_array
+*/
+
+#ifndef SOA_ARRAY_HPP_
+#define SOA_ARRAY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Change_tracking.hpp"
+#include "Serialization.hpp"
+
+namespace ecs {
+    /**
+     * @brief List the fields of an aggregate component stored in a soa_array, specialize it with a tuple of member pointers:
+     * @code
+     * template <> struct ecs::soa_fields<position> {
+     *     static constexpr auto fields = std::make_tuple(&position::x, &position::y);
+     * };
+     * @endcode
+     * Fields that are not listed are not stored.
+     *
+     * @tparam Component
+     */
+    template <class Component> struct soa_fields;
+
+    namespace detail {
+        template <class Member> struct member_type;
+        template <class Class, class Type> struct member_type<Type Class::*> {
+            using type = Type;
+        };
+
+        /**
+         * @brief Allocator of the soa_array columns, aligned on a cache line so loops over a field can use aligned SIMD accesses
+         *
+         * @tparam T
+         */
+        template <class T> struct column_allocator {
+            using value_type = T;
+            static constexpr std::size_t alignment = alignof(T) > 64 ? alignof(T) : 64;
+
+            column_allocator() = default;
+            template <class U> column_allocator(column_allocator<U> const &) noexcept {}
+
+            T *allocate(std::size_t n)
+            {
+                return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+            }
+            void deallocate(T *ptr, std::size_t) noexcept
+            {
+                ::operator delete(ptr, std::align_val_t(alignment));
+            }
+            template <class U> bool operator==(column_allocator<U> const &) const noexcept { return true; }
+            template <class U> bool operator!=(column_allocator<U> const &) const noexcept { return false; }
+        };
+    }
+
+    /**
+     * @brief Contiguous view of one field of the components of a soa_array
+     *
+     * @tparam T type of the field, const to only read it
+     */
+    template <class T> class field_span {
+    public:
+        /**
+         * @brief Construct a new field span object
+         *
+         * @param data first value
+         * @param size number of values
+         */
+        field_span(T *data, std::size_t size) : _data(data), _size(size) {}
+
+        T *data() const { return _data; }
+        std::size_t size() const { return _size; }
+        T *begin() const { return _data; }
+        T *end() const { return _data + _size; }
+        T &operator[](std::size_t i) const { return _data[i]; }
+
+    private:
+        T *_data;
+        std::size_t _size;
+    };
+
+    template <class Component> class soa_array;
+
+    /**
+     * @brief Nullable reference to a component of a soa_array, returned by its accessors since the fields of the component are not
+     * stored together. Access a field with get, or copy the whole component with load.
+     *
+     * @tparam Array soa_array, const to only read the component
+     */
+    template <class Array> class soa_ref {
+    public:
+        using component_type = typename std::remove_const_t<Array>::component_type;
+
+        /**
+         * @brief Construct a new soa ref object
+         *
+         * @param array containing the component, nullptr if the entity does not have it
+         * @param pos of the component in the columns
+         */
+        soa_ref(Array *array, std::size_t pos) : _array(array), _pos(pos) {}
+
+        bool has_value() const { return _array != nullptr; }
+        explicit operator bool() const { return has_value(); }
+
+        /**
+         * @brief Access a field of the component
+         *
+         * @tparam Member pointer to the field, listed in soa_fields
+         * @return reference to the field
+         */
+        template <auto Member> decltype(auto) get() const
+        {
+            return _array->template field<Member>()[_pos];
+        }
+        /**
+         * @brief Copy the listed fields in a component. Throws a std::bad_optional_access if the reference is empty.
+         *
+         * @return component_type
+         */
+        component_type load() const
+        {
+            if (!_array)
+                throw std::bad_optional_access();
+            return _array->load(_pos);
+        }
+        /**
+         * @brief Write the listed fields of a component
+         *
+         * @param component to write
+         */
+        void store(component_type const &component) const
+        {
+            if (!_array)
+                throw std::bad_optional_access();
+            _array->store(_pos, component);
+        }
+
+    private:
+        Array *_array;
+        std::size_t _pos;
+    };
+
+    /**
+     * @brief Store an aggregate component as a structure of arrays: each field listed in soa_fields lives in its own contiguous
+     * aligned column, in the same order as the entities. Use it with component_storage:
+     * @code
+     * template <> struct ecs::component_storage<position> { using type = ecs::soa_array<position>; };
+     * @endcode
+     * Removing a component moves the last one in its place, like packed_array. Change tracking is not supported.
+     *
+     * @tparam Component
+     */
+    template <typename Component> class soa_array {
+        static_assert(!track_changes_v<Component>, "soa_array does not support change tracking");
+
+        static constexpr auto fields = soa_fields<Component>::fields;
+        static constexpr std::size_t field_count = std::tuple_size_v<std::remove_const_t<decltype(fields)>>;
+
+        template <std::size_t I> using field_type = typename detail::member_type<std::remove_const_t<std::tuple_element_t<I, std::remove_const_t<decltype(fields)>>>>::type;
+        template <class T> using column = std::vector<T, detail::column_allocator<T>>;
+        template <class Sequence> struct columns_of;
+        template <std::size_t... Is> struct columns_of<std::index_sequence<Is...>> {
+            using type = std::tuple<column<field_type<Is>>...>;
+        };
+        using columns_t = typename columns_of<std::make_index_sequence<field_count>>::type;
+
+        template <class Other> friend class soa_array;
+
+    public:
+        using component_type = Component;
+        using size_type = std::size_t;
+        using reference_type = soa_ref<soa_array>;
+        using const_reference_type = soa_ref<soa_array const>;
+
+        using index_type = std::uint32_t; /**< entities and positions in the columns, an entity index fits in 32 bits */
+
+        static constexpr size_type npos = static_cast<size_type>(-1); /**< index returned when there is no component */
+        static constexpr index_type absent = static_cast<index_type>(-1); /**< position of an entity without component */
+
+        /**
+         * @brief Get the column of a field
+         *
+         * @tparam Member pointer to the field, listed in soa_fields
+         * @return field_span over the components, in the order of entities()
+         */
+        template <auto Member> auto field()
+        {
+            auto &col = std::get<field_index<Member>()>(_columns);
+
+            return field_span<typename std::decay_t<decltype(col)>::value_type>(col.data(), col.size());
+        }
+        /**
+         * @brief Get the column of a field (const)
+         *
+         * @tparam Member pointer to the field, listed in soa_fields
+         * @return field_span over the components, in the order of entities()
+         */
+        template <auto Member> auto field() const
+        {
+            auto &col = std::get<field_index<Member>()>(_columns);
+
+            return field_span<typename std::decay_t<decltype(col)>::value_type const>(col.data(), col.size());
+        }
+
+        /**
+         * @brief Access the component of an entity. Can throw a std::out_of_range exception.
+         *
+         * @param idx entity to access
+         * @return reference_type, empty if the entity does not have the component
+         */
+        reference_type operator[](size_t idx)
+        {
+            if (idx >= _sparse.size())
+                throw std::out_of_range("Index out of range");
+            return reference_type(_sparse[idx] == absent ? nullptr : this, _sparse[idx]);
+        }
+        /**
+         * @brief Access the component of an entity. Can throw a std::out_of_range exception. (const)
+         *
+         * @param idx entity to access
+         * @return const_reference_type, empty if the entity does not have the component
+         */
+        const_reference_type operator[](size_t idx) const
+        {
+            if (idx >= _sparse.size())
+                throw std::out_of_range("Index out of range");
+            return const_reference_type(_sparse[idx] == absent ? nullptr : this, _sparse[idx]);
+        }
+        /**
+         * @brief Get the number of indexes covered by the soa_array, like sparse_array::size()
+         *
+         * @return size_type
+         */
+        size_type size() const
+        {
+            return _sparse.size();
+        }
+        /**
+         * @brief Get the number of components stored
+         *
+         * @return size_type
+         */
+        size_type live_count() const
+        {
+            return _entities.size();
+        }
+        /**
+         * @brief Get the number of components the allocated columns can hold
+         *
+         * @return size_type
+         */
+        size_type capacity() const
+        {
+            return std::get<0>(_columns).capacity();
+        }
+        /**
+         * @brief Get the number of bytes allocated: the columns, the entities and the sparse index
+         *
+         * @return size_type
+         */
+        size_type memory_usage() const
+        {
+            size_type bytes = (_entities.capacity() + _sparse.capacity()) * sizeof(index_type);
+
+            std::apply([&bytes](auto const &...cols) { ((bytes += cols.capacity() * sizeof(typename std::decay_t<decltype(cols)>::value_type)), ...); }, _columns);
+            return bytes;
+        }
+        /**
+         * @brief Get the number of times the storage grew (the components or the sparse index reallocated) since the last reset
+         *
+         * @return size_type
+         */
+        size_type resize_count() const
+        {
+            return _resizes;
+        }
+        /**
+         * @brief Reset the count of resize_count to 0
+         *
+         */
+        void reset_resize_count()
+        {
+            _resizes = 0;
+        }
+        /**
+         * @brief Check if an entity has a component
+         *
+         * @param idx entity to check
+         * @return true if the entity has a component
+         */
+        bool contains(size_type idx) const
+        {
+            return idx < _sparse.size() && _sparse[idx] != absent;
+        }
+        /**
+         * @brief Access the component of an entity without checking it exists
+         *
+         * @param idx entity to access
+         * @return reference_type
+         */
+        reference_type get(size_type idx)
+        {
+            return reference_type(this, _sparse[idx]);
+        }
+        /**
+         * @brief Access the component of an entity without checking it exists (const)
+         *
+         * @param idx entity to access
+         * @return const_reference_type
+         */
+        const_reference_type get(size_type idx) const
+        {
+            return const_reference_type(this, _sparse[idx]);
+        }
+        /**
+         * @brief Get the number of positions to walk when this array drives a zipper, only the live components are walked
+         *
+         * @return size_type
+         */
+        size_type scan_size() const
+        {
+            return _entities.size();
+        }
+        /**
+         * @brief Get the entity found at a position of the walk done by a zipper
+         *
+         * @param pos in the walk, lower than scan_size()
+         * @return size_type entity
+         */
+        size_type scan_index(size_type pos) const
+        {
+            return _entities[pos];
+        }
+        /**
+         * @brief Get the entities owning the components, in the same order as the columns
+         *
+         * @return std::vector<index_type> const&
+         */
+        std::vector<index_type> const &entities() const
+        {
+            return _entities;
+        }
+        /**
+         * @brief Insert a component for an entity. If the entity already has one, it is replaced.
+         *
+         * @param pos entity to insert to
+         * @param component component to insert
+         * @return reference_type
+         */
+        reference_type insert_at(size_type pos, Component const &component)
+        {
+            if (pos >= absent)
+                throw std::out_of_range("Index out of range");
+            if (pos >= _sparse.size()) {
+                if (pos >= _sparse.capacity())
+                    _resizes++;
+                _sparse.resize(pos + 1, absent);
+            }
+            if (_sparse[pos] == absent) {
+                if (_entities.size() == _entities.capacity())
+                    _resizes++;
+                _sparse[pos] = static_cast<index_type>(_entities.size());
+                _entities.push_back(static_cast<index_type>(pos));
+                push(component, std::make_index_sequence<field_count>());
+            } else {
+                store(_sparse[pos], component);
+            }
+            return reference_type(this, _sparse[pos]);
+        }
+        /**
+         * @brief Make room for components up to a given entity, so the next insertions do not reallocate
+         *
+         * @param size number of entities covered by the sparse index
+         * @param count number of components about to be inserted
+         */
+        void reserve(size_type size, size_type count = 0)
+        {
+            if (size > _sparse.capacity() || _entities.size() + count > _entities.capacity())
+                _resizes++;
+            if (size > _sparse.size())
+                _sparse.resize(size, absent);
+            _entities.reserve(_entities.size() + count);
+            std::apply([count](auto &...cols) { (cols.reserve(cols.size() + count), ...); }, _columns);
+        }
+        /**
+         * @brief Remove the component of an entity. The last component is moved in its place. If the entity has no component, nothing will happen.
+         *
+         * @tparam Params
+         * @param pos entity of the component to remove
+         */
+        template <class... Params> void erase(size_type pos)
+        {
+            if (pos >= _sparse.size() || _sparse[pos] == absent)
+                return;
+            size_type hole = _sparse[pos];
+
+            swap_positions(hole, _entities.size() - 1);
+            _entities.pop_back();
+            std::apply([](auto &...cols) { (cols.pop_back(), ...); }, _columns);
+            _sparse[pos] = absent;
+        }
+        /**
+         * @brief Remove all the components. The removals are not logged, used to restore a snapshot.
+         *
+         */
+        void clear()
+        {
+            std::apply([](auto &...cols) { (cols.clear(), ...); }, _columns);
+            _entities.clear();
+            _sparse.clear();
+        }
+        /**
+         * @brief Reorder this array and another one so the entities having both components come first, in the same order.
+         * The fields of both arrays can then be walked together with the same index:
+         * @code
+         * std::size_t count = positions.pack_with(velocities);
+         * auto px = positions.field<&position::x>();
+         * auto vx = velocities.field<&velocity::x>();
+         * for (std::size_t i = 0; i < count; i++)
+         *     px[i] += vx[i] * dt;
+         * @endcode
+         * The order stays valid until a component is removed from one of the arrays or inserted in only one of them.
+         *
+         * @tparam Other component of the other array
+         * @param other array to reorder with this one
+         * @return size_type number of entities having both components
+         */
+        template <class Other> size_type pack_with(soa_array<Other> &other)
+        {
+            size_type count = 0;
+
+            for (size_type i = 0; i < _entities.size(); i++) {
+                size_type entity = _entities[i];
+
+                if (!other.contains(entity))
+                    continue;
+                swap_positions(i, count);
+                other.swap_positions(other._sparse[entity], count);
+                count++;
+            }
+            return count;
+        }
+        /**
+         * @brief Move the component of an entity to a position of the columns, the component at this position takes its place.
+         * Used by the owning groups of the registry to keep their components first.
+         *
+         * @param pos entity of the component to move, must have one
+         * @param index position in the columns
+         */
+        void move_to(size_type pos, size_type index)
+        {
+            swap_positions(_sparse[pos], index);
+        }
+
+        /**
+         * @brief Write the content of the soa_array, column by column
+         *
+         * @param writer to write to
+         */
+        void snapshot(binary_writer &writer) const
+        {
+            writer.write_size(_sparse.size());
+            writer.write_size(_entities.size());
+            writer.write_uints<std::uint32_t>(_entities.data(), _entities.size());
+            std::apply([&writer](auto const &...cols) { (write_components(writer, cols.data(), cols.size()), ...); }, _columns);
+        }
+        /**
+         * @brief Replace the content of the soa_array by one written by snapshot
+         *
+         * @param reader to read from
+         */
+        void restore(binary_reader &reader)
+        {
+            size_type size = reader.read_size();
+
+            if (size > absent)
+                throw std::runtime_error("Invalid soa_array snapshot");
+            std::vector<index_type> sparse(size, absent);
+            std::vector<index_type> entities(reader.read_size());
+            columns_t columns;
+
+            reader.read_uints<std::uint32_t>(entities.data(), entities.size());
+            std::apply([&](auto &...cols) { (read_column(reader, cols, entities.size()), ...); }, columns);
+            for (size_type i = 0; i < entities.size(); i++) {
+                if (entities[i] >= sparse.size())
+                    throw std::runtime_error("Invalid soa_array snapshot");
+                sparse[entities[i]] = static_cast<index_type>(i);
+            }
+            _columns = std::move(columns);
+            _entities = std::move(entities);
+            _sparse = std::move(sparse);
+        }
+
+    private:
+        template <auto Member, class Field> static constexpr bool is_member(Field field)
+        {
+            if constexpr (std::is_same_v<Field, decltype(Member)>)
+                return field == Member;
+            else
+                return false;
+        }
+        template <auto Member, std::size_t... Is> static constexpr std::size_t find_field(std::index_sequence<Is...>)
+        {
+            std::size_t index = field_count;
+
+            ((index = (index == field_count && is_member<Member>(std::get<Is>(fields))) ? Is : index), ...);
+            return index;
+        }
+        template <auto Member> static constexpr std::size_t field_index()
+        {
+            constexpr std::size_t index = find_field<Member>(std::make_index_sequence<field_count>());
+
+            static_assert(index < field_count, "This field is not listed in soa_fields");
+            return index;
+        }
+
+        template <std::size_t... Is> void push(Component const &component, std::index_sequence<Is...>)
+        {
+            (std::get<Is>(_columns).push_back(component.*std::get<Is>(fields)), ...);
+        }
+        template <std::size_t... Is> void store(size_type pos, Component const &component, std::index_sequence<Is...>)
+        {
+            ((std::get<Is>(_columns)[pos] = component.*std::get<Is>(fields)), ...);
+        }
+        template <std::size_t... Is> Component load(size_type pos, std::index_sequence<Is...>) const
+        {
+            Component component{};
+
+            ((component.*std::get<Is>(fields) = std::get<Is>(_columns)[pos]), ...);
+            return component;
+        }
+        void store(size_type pos, Component const &component)
+        {
+            store(pos, component, std::make_index_sequence<field_count>());
+        }
+        Component load(size_type pos) const
+        {
+            return load(pos, std::make_index_sequence<field_count>());
+        }
+        void swap_positions(size_type a, size_type b)
+        {
+            if (a == b)
+                return;
+            std::apply([a, b](auto &...cols) { (std::swap(cols[a], cols[b]), ...); }, _columns);
+            std::swap(_entities[a], _entities[b]);
+            _sparse[_entities[a]] = static_cast<index_type>(a);
+            _sparse[_entities[b]] = static_cast<index_type>(b);
+        }
+        template <class Column> static void read_column(binary_reader &reader, Column &col, size_type count)
+        {
+            using value_type = typename Column::value_type;
+
+            if constexpr (std::is_trivially_copyable_v<value_type>) {
+                col.resize(count);
+                reader.read_bytes(col.data(), count * sizeof(value_type));
+            } else {
+                col.reserve(count);
+                for (size_type i = 0; i < count; i++)
+                    col.push_back(read_component<value_type>(reader));
+            }
+        }
+
+        friend reference_type;
+        friend const_reference_type;
+
+        columns_t _columns;
+        std::vector<index_type> _entities;
+        std::vector<index_type> _sparse;
+        size_type _resizes = 0;
+    };
+}
+
+#endif /* !SOA_ARRAY_HPP_ */
@@ -8,26 +8,292 @@
 #ifndef SPARSE_ARRAY_HPP_
 #define SPARSE_ARRAY_HPP_
 
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <new>
 #include <optional>
+#include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <stdexcept>
+#include "Change_tracking.hpp"
+#include "Serialization.hpp"
 
 namespace ecs {
     /**
-     * @brief Sparse array class, used to store an array of optional components
+     * @brief Number of indexes of a page of the sparse_array of a component, 512 by default. The size of the pages follows
+     * the size of the component, so the pools of small components (tags, flags) on a few entities get small pages.
+     * Specialize it to change it:
+     * @code
+     * template <> struct ecs::sparse_page_slots<position> : std::integral_constant<std::size_t, 4096> {};
+     * @endcode
+     *
+     * @tparam Component
+     */
+    template <class Component> struct sparse_page_slots : std::integral_constant<std::size_t, 512> {};
+
+    /**
+     * @brief Sparse array class, used to store an array of optional components.
+     * The slots are allocated by pages of page_size indexes (at least sparse_page_slots) when a component is inserted in them, so a high entity id
+     * does not allocate the slots of all the lower ones, and growing the array never moves the existing components.
+     * The pages are aligned on their size, so get_index finds the page holding a component from its address in the table of the pages allocated.
      * 
      * @tparam Component 
      */
     template <typename Component> class sparse_array {
     public:
+        class slot_ref;
+
         using value_type = std::optional<Component>;
-        using reference_type = value_type &;
+        using reference_type = slot_ref;
         using const_reference_type = value_type const &;
-        using container_t = std::vector<value_type>;
-        using size_type = typename container_t::size_type;
-        using iterator = typename container_t::iterator;
-        using const_iterator = typename container_t::const_iterator;
+        using size_type = std::size_t;
+
+        static constexpr size_type npos = static_cast<size_type>(-1); /**< index returned when there is no component */
+
+    private:
+        static constexpr size_type slot_bytes = sizeof(value_type) + (track_changes_v<Component> ? 2 * sizeof(tick_t) : 0);
+        static constexpr size_type page_header = 64;
+
+        static_assert(sparse_page_slots<Component>::value > 0, "A sparse_array page needs at least one index");
+
+        static constexpr size_type compute_page_bytes()
+        {
+            size_type bytes = 2 * page_header;
+
+            while (bytes < page_header + sparse_page_slots<Component>::value * slot_bytes)
+                bytes *= 2;
+            return bytes;
+        }
+
+    public:
+        static constexpr size_type page_bytes = compute_page_bytes(); /**< size and alignment of a page */
+        static constexpr size_type page_size = (page_bytes - page_header) / slot_bytes; /**< number of indexes of a page */
+
+    private:
+        struct page {
+            size_type base = 0; /**< index of the first slot */
+            size_type live = 0;
+            std::array<value_type, page_size> slots{};
+        };
+        struct tracked_page : page {
+            std::array<tick_t, page_size> added{};
+            std::array<tick_t, page_size> changed{};
+        };
+        using page_t = std::conditional_t<track_changes_v<Component>, tracked_page, page>;
+
+        static_assert(sizeof(page_t) <= page_bytes && alignof(page_t) <= page_bytes, "Component too aligned for a sparse_array page");
+
+        struct page_deleter {
+            void operator()(page_t *p) const
+            {
+                p->~page_t();
+                ::operator delete(p, std::align_val_t(page_bytes));
+            }
+        };
+        using page_ptr = std::unique_ptr<page_t, page_deleter>;
+
+        /**
+         * @brief Iterator over all the indexes of the sparse_array. The indexes of the pages that are not allocated read as empty,
+         * the iterator gives a slot_ref, which only allocates a page when a component is assigned to it.
+         *
+         * @tparam Array sparse_array, const for a const_iterator
+         * @tparam Reference slot_ref, value_type const & for a const_iterator
+         */
+        template <class Array, class Reference> class slot_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename sparse_array::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = Reference;
+
+            struct pointer {
+                Reference ref;
+
+                std::remove_reference_t<Reference> *operator->() { return std::addressof(ref); }
+            };
+
+            slot_iterator(Array *array, size_type idx) : _array(array), _idx(idx) {}
+
+            reference operator*() const { return _array->slot(_idx); }
+            pointer operator->() const { return pointer{**this}; }
+            slot_iterator &operator++() { _idx++; return *this; }
+            slot_iterator operator++(int) { slot_iterator it = *this; _idx++; return it; }
+            bool operator==(slot_iterator const &other) const { return _idx == other._idx; }
+            bool operator!=(slot_iterator const &other) const { return _idx != other._idx; }
+
+        private:
+            Array *_array;
+            size_type _idx;
+        };
+
+    public:
+        /**
+         * @brief Reference to a slot of the sparse_array, returned by the mutable accessors in place of an optional.
+         * Reading a slot does not allocate its page, only assigning a component does, and assigning or resetting it
+         * keeps live_count exact. A present component is stamped as changed when the reference is taken.
+         * The accessors returned a std::optional<Component> & before the pages, bind the slot_ref by value or with auto &&.
+         *
+         */
+        class slot_ref {
+        public:
+            /**
+             * @brief Construct a new slot ref object
+             *
+             * @param array holding the slot
+             * @param idx of the slot
+             */
+            slot_ref(sparse_array *array, size_type idx) : _array(array), _idx(idx), _slot(array->find_slot(idx))
+            {
+                if (has_value())
+                    _array->touch(*_array->_pages[idx / page_size], idx);
+            }
+            slot_ref(slot_ref const &) = default;
+
+            /**
+             * @brief Check if the slot holds a component
+             *
+             * @return true if the component is present
+             */
+            bool has_value() const
+            {
+                return _slot && _slot->has_value();
+            }
+            /**
+             * @brief Check if the slot holds a component
+             *
+             * @return true if the component is present
+             */
+            explicit operator bool() const
+            {
+                return has_value();
+            }
+            /**
+             * @brief Read the slot as an optional, an empty one if its page is not allocated
+             *
+             * @return value_type const&
+             */
+            operator value_type const &() const
+            {
+                return _slot ? *_slot : std::as_const(*_array).slot(_idx);
+            }
+            /**
+             * @brief Access the component. Throws a std::bad_optional_access if there is none.
+             *
+             * @return Component&
+             */
+            Component &value() const
+            {
+                if (!has_value())
+                    throw std::bad_optional_access();
+                return **_slot;
+            }
+            /**
+             * @brief Access the component without checking it is present
+             *
+             * @return Component&
+             */
+            Component &operator*() const
+            {
+                return **_slot;
+            }
+            /**
+             * @brief Access the component members without checking it is present
+             *
+             * @return Component*
+             */
+            Component *operator->() const
+            {
+                return std::addressof(**_slot);
+            }
+            /**
+             * @brief Put a component in the slot, allocating its page if needed
+             *
+             * @param component to copy
+             * @return slot_ref&
+             */
+            slot_ref &operator=(Component const &component)
+            {
+                _slot = &_array->emplace(_idx, component);
+                return *this;
+            }
+            /**
+             * @brief Put a component in the slot, allocating its page if needed
+             *
+             * @param component to move
+             * @return slot_ref&
+             */
+            slot_ref &operator=(Component &&component)
+            {
+                _slot = &_array->emplace(_idx, std::move(component));
+                return *this;
+            }
+            /**
+             * @brief Copy an optional in the slot: assign its component, or remove the one of the slot if it is empty
+             *
+             * @param other optional to copy
+             * @return slot_ref&
+             */
+            slot_ref &operator=(value_type const &other)
+            {
+                if (other.has_value())
+                    return *this = *other;
+                reset();
+                return *this;
+            }
+            /**
+             * @brief Copy the content of another slot
+             *
+             * @param other slot to copy
+             * @return slot_ref&
+             */
+            slot_ref &operator=(slot_ref const &other)
+            {
+                return *this = static_cast<value_type const &>(other);
+            }
+            /**
+             * @brief Remove the component of the slot
+             *
+             * @return slot_ref&
+             */
+            slot_ref &operator=(std::nullopt_t)
+            {
+                reset();
+                return *this;
+            }
+            /**
+             * @brief Construct a component in the slot, allocating its page if needed
+             *
+             * @param args of the constructor of the component
+             * @return Component&
+             */
+            template <class... Args> Component &emplace(Args &&...args)
+            {
+                _slot = &_array->emplace(_idx, Component(std::forward<Args>(args)...));
+                return **_slot;
+            }
+            /**
+             * @brief Remove the component of the slot, like erase
+             *
+             */
+            void reset()
+            {
+                _array->erase(_idx);
+            }
+
+        private:
+            sparse_array *_array;
+            size_type _idx;
+            value_type *_slot; /**< nullptr while the page of the slot is not allocated */
+        };
+
+        using iterator = slot_iterator<sparse_array, slot_ref>;
+        using const_iterator = slot_iterator<sparse_array const, value_type const &>;
 
     public:
         /**
@@ -40,7 +306,11 @@ namespace ecs {
          * 
          * @param from sparse_array to copy
          */
-        sparse_array(sparse_array const &from) = default;
+        sparse_array(sparse_array const &from)
+            : _pages(copy_pages(from._pages)), _size(from._size), _live(from._live), _tick(from._tick), _removed(from._removed), _log(from._log)
+        {
+            index_pages();
+        }
         /**
          * @brief Move construct a new sparse array object
          * 
@@ -59,7 +329,19 @@ namespace ecs {
          * 
          * @param from sparse_array to copy
          */
-        sparse_array &operator=(sparse_array const &from) = default;
+        sparse_array &operator=(sparse_array const &from)
+        {
+            if (this != &from) {
+                _pages = copy_pages(from._pages);
+                index_pages();
+                _size = from._size;
+                _live = from._live;
+                _tick = from._tick;
+                _removed = from._removed;
+                _log = from._log;
+            }
+            return *this;
+        }
         /**
          * @brief Move assign a new sparse array object
          * 
@@ -70,15 +352,16 @@ namespace ecs {
         // vector functions overload
         /**
          * @brief Overload of operator[] to access the sparse_array at a given index. Can throw a std::out_of_range exception.
+         * Reading the slot does not allocate its page, assigning a component to it does.
          * 
          * @param idx to access
          * @return reference_type 
          */
         reference_type operator[](size_t idx)
         {
-            if (idx >= _data.size())
+            if (idx >= _size)
                 throw std::out_of_range("Index out of range");
-            return _data[idx];
+            return slot_ref(this, idx);
         }
         /**
          * @brief Overload of operator[] to access the sparse_array at a given index. Can throw a std::out_of_range exception. (const)
@@ -88,9 +371,9 @@ namespace ecs {
          */
         const_reference_type operator[](size_t idx) const
         {
-            if (idx >= _data.size())
+            if (idx >= _size)
                 throw std::out_of_range("Index out of range");
-            return _data[idx];
+            return slot(idx);
         };
         /**
          * @brief Overlaod of begin() to access the begin of the sparse_array
@@ -99,7 +382,7 @@ namespace ecs {
          */
         iterator begin()
         {
-            return _data.begin();
+            return iterator(this, 0);
         };
         /**
          * @brief Overlaod of begin() to access the begin of the sparse_array (const)
@@ -108,7 +391,7 @@ namespace ecs {
          */
         const_iterator begin() const
         {
-            return _data.begin();
+            return const_iterator(this, 0);
         };
         /**
          * @brief Overlaod of cbegin() to access the begin of the sparse_array (const)
@@ -117,7 +400,7 @@ namespace ecs {
          */
         const_iterator cbegin() const
         {
-            return _data.cbegin();
+            return const_iterator(this, 0);
         };
         /**
          * @brief Overlaod of end() to access the end of the sparse_array
@@ -126,7 +409,7 @@ namespace ecs {
          */
         iterator end()
         {
-            return _data.end();
+            return iterator(this, _size);
         };
         /**
          * @brief Overlaod of end() to access the end of the sparse_array (const)
@@ -135,7 +418,7 @@ namespace ecs {
          */
         const_iterator end() const
         {
-            return _data.end();
+            return const_iterator(this, _size);
         };
         /**
          * @brief Overlaod of cend() to access the end of the sparse_array (const)
@@ -144,7 +427,7 @@ namespace ecs {
          */
         const_iterator cend() const
         {
-            return _data.cend();
+            return const_iterator(this, _size);
         };
         /**
          * @brief Overlaod of size() to access the size of the sparse_array
@@ -153,8 +436,71 @@ namespace ecs {
          */
         size_type size() const
         {
-            return _data.size();
+            return _size;
         };
+        /**
+         * @brief Get the number of components stored
+         *
+         * @return size_type
+         */
+        size_type live_count() const
+        {
+            return _live;
+        }
+        /**
+         * @brief Check if there is a component at a given index
+         *
+         * @param idx to check
+         * @return true if there is a component
+         */
+        bool contains(size_type idx) const
+        {
+            value_type const *slot = find_slot(idx);
+
+            return slot && slot->has_value();
+        }
+        /**
+         * @brief Access the component at a given index without checking it exists
+         *
+         * @param idx to access
+         * @return Component&
+         */
+        Component &get(size_type idx)
+        {
+            page_t &p = *_pages[idx / page_size];
+
+            touch(p, idx);
+            return *p.slots[idx % page_size];
+        }
+        /**
+         * @brief Access the component at a given index without checking it exists (const)
+         *
+         * @param idx to access
+         * @return Component const&
+         */
+        Component const &get(size_type idx) const
+        {
+            return *_pages[idx / page_size]->slots[idx % page_size];
+        }
+        /**
+         * @brief Get the number of positions to walk when this array drives a zipper
+         *
+         * @return size_type
+         */
+        size_type scan_size() const
+        {
+            return _size;
+        }
+        /**
+         * @brief Get the index found at a position of the walk done by a zipper
+         *
+         * @param pos in the walk, lower than scan_size()
+         * @return size_type index, or npos if there is no component at this position
+         */
+        size_type scan_index(size_type pos) const
+        {
+            return contains(pos) ? pos : npos;
+        }
         /**
          * @brief Insert a component at a given position in the sparse_array. If the position is out of range, the sparse_array will be resized.
          * 
@@ -164,11 +510,8 @@ namespace ecs {
          */
         reference_type insert_at(size_type pos, Component const &component)
         {
-            if (pos >= _data.size()) {
-                _data.resize(pos + 1);
-            }
-            _data[pos] = component;
-            return _data[pos];
+            emplace(pos, component);
+            return slot_ref(this, pos);
         }
         /**
          * @brief Insert a component at a given position in the sparse_array. If the position is out of range, the sparse_array will be resized. Like the previous one, but move the component instead of copying it.
@@ -179,11 +522,23 @@ namespace ecs {
          */
         reference_type insert_at(size_type pos, Component &&component)
         {
-            if (pos >= _data.size()) {
-                _data.resize(pos + 1);
+            emplace(pos, std::move(component));
+            return slot_ref(this, pos);
+        }
+        /**
+         * @brief Make room for components up to a given index. Only the table of pages grows, the pages are still allocated on insertion.
+         *
+         * @param size number of indexes to cover
+         * @param count number of components about to be inserted, unused as every index already has its slot
+         */
+        void reserve(size_type size, size_type count = 0)
+        {
+            (void)count;
+            if (size > _size) {
+                _size = size;
+                if (page_count(size) > _pages.size())
+                    grow_table(page_count(size));
             }
-            _data[pos] = std::move(component);
-            return _data[pos];
         }
         /**
          * @brief Remove a component at a given position in the sparse_array. Does not resize the sparse_array, it only replace the component by nothing. If the position is out of range, nothing will happen.
@@ -193,13 +548,97 @@ namespace ecs {
          */
         template <class... Params> void erase(size_type pos)
         {
-            if (pos >= _data.size()) {
+            if (!contains(pos)) {
                 return;
             }
-            _data[pos].reset();
+            page_t &p = *_pages[pos / page_size];
+
+            p.slots[pos % page_size].reset();
+            p.live--;
+            _live--;
+            if constexpr (track_changes_v<Component>)
+                _removed.emplace_back(pos, _tick);
         }
         /**
-         * @brief Get the index of a component in the sparse_array. If the component is not in the sparse_array, -1 will be returned.
+         * @brief Remove all the components and free the pages. The removals are not logged, used to restore a snapshot.
+         *
+         */
+        void clear()
+        {
+            _pages.clear();
+            _page_index.clear();
+            _size = 0;
+            _live = 0;
+            _log.reset(_tick);
+        }
+        /**
+         * @brief Free the pages that do not hold any component anymore. Their indexes stay in the sparse_array and read as empty.
+         *
+         * @return size_type number of pages freed
+         */
+        size_type release_empty_pages()
+        {
+            size_type released = 0;
+
+            for (auto &p : _pages) {
+                if (p && p->live == 0) {
+                    _page_index.erase(reinterpret_cast<std::uintptr_t>(p.get()));
+                    p.reset();
+                    released++;
+                }
+            }
+            return released;
+        }
+        /**
+         * @brief Get the number of pages allocated
+         *
+         * @return size_type
+         */
+        size_type allocated_pages() const
+        {
+            return std::count_if(_pages.begin(), _pages.end(), [](auto const &p) { return p != nullptr; });
+        }
+        /**
+         * @brief Get the number of slots of the allocated pages
+         *
+         * @return size_type
+         */
+        size_type capacity() const
+        {
+            return allocated_pages() * page_size;
+        }
+        /**
+         * @brief Get the number of bytes allocated: the pages, the tables of pages, the tracked removals
+         *
+         * @return size_type
+         */
+        size_type memory_usage() const
+        {
+            return allocated_pages() * page_bytes + _pages.capacity() * sizeof(page_ptr)
+                + _page_index.size() * (sizeof(std::pair<std::uintptr_t, size_type>) + sizeof(void *)) + _page_index.bucket_count() * sizeof(void *)
+                + _removed.capacity() * sizeof(std::pair<size_type, tick_t>) + _log.memory_usage();
+        }
+        /**
+         * @brief Get the number of times the storage grew (a page allocated or the table of pages reallocated) since the last reset
+         *
+         * @return size_type
+         */
+        size_type resize_count() const
+        {
+            return _resizes;
+        }
+        /**
+         * @brief Reset the count of resize_count to 0
+         *
+         */
+        void reset_resize_count()
+        {
+            _resizes = 0;
+        }
+        /**
+         * @brief Get the index of a component in the sparse_array, in constant time: its address aligned on the size of the
+         * pages is looked up in the pages allocated, the value is only read as a slot of a page once the page is found.
+         * -1 is returned if the value is empty or is not a slot of this sparse_array (a copy, a local, a slot of another one).
          * 
          * @param value component to get the index of
          * @return size_type 
@@ -209,18 +648,348 @@ namespace ecs {
             if (!value.has_value())
                 return -1;
 
-            auto addrval = std::addressof(value.value());
+            std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(std::addressof(value));
+            auto found = _page_index.find(addr & ~static_cast<std::uintptr_t>(page_bytes - 1));
+
+            if (found == _page_index.end())
+                return -1;
+            page_t const &p = *_pages[found->second];
+            std::uintptr_t first = reinterpret_cast<std::uintptr_t>(p.slots.data());
+
+            if (addr < first || addr >= first + page_size * sizeof(value_type) || (addr - first) % sizeof(value_type) != 0)
+                return -1;
+            return p.base + (addr - first) / sizeof(value_type);
+        }
+
+        /**
+         * @brief Write the content of the sparse_array, page by page: the first index of the page, the bits of its used
+         * slots, then their components. The size of the pages depends on the build, the restore does not need the same one.
+         * Trivially copyable components are copied as their bytes, a run of used slots at once, others need a serializer.
+         *
+         * @param writer to write to
+         */
+        void snapshot(binary_writer &writer) const
+        {
+            constexpr size_type page_record = sizeof(std::uint64_t) + sizeof(std::uint32_t) + (page_size + 7) / 8;
+
+            writer.write_size(_size);
+            writer.write_size(live_count());
+            writer.write_size(allocated_pages());
+            writer.reserve(allocated_pages() * page_record + (std::is_trivially_copyable_v<Component> ? _live * sizeof(Component) : 0));
+            for (size_type i = 0; i < _pages.size(); i++) {
+                if (!_pages[i])
+                    continue;
+                auto const &slots = _pages[i]->slots;
+                std::bitset<page_size> present;
 
-            for (auto it = _data.begin(); it != _data.end(); ++it) {
-                if (it->has_value() && std::addressof(it->value()) == addrval) {
-                    return std::distance(_data.begin(), it);
+                for (size_type j = 0; j < page_size; j++)
+                    present[j] = slots[j].has_value();
+                writer.write_size(i * page_size);
+                writer.write_bits(present);
+                for (size_type j = 0; j < page_size; j++) {
+                    size_type first = j;
+
+                    while (j < page_size && present[j])
+                        j++;
+                    if (j > first)
+                        write_slots(writer, slots.data() + first, j - first);
                 }
             }
-            return -1;
+        }
+        /**
+         * @brief Replace the content of the sparse_array by one written by snapshot. The components of a run of used slots
+         * are read at once.
+         *
+         * @param reader to read from
+         */
+        void restore(binary_reader &reader)
+        {
+            size_type size = reader.read_size();
+            size_type live = reader.read_size();
+            size_type count = reader.read_size();
+            size_type counted = 0;
+            std::vector<page_ptr> pages(page_count(size));
+            std::vector<size_type> used;
+
+            for (size_type n = 0; n < count; n++) {
+                size_type first = reader.read_size();
+
+                used.clear();
+                reader.for_each_bit([&used, first](std::size_t bit) { used.push_back(first + bit); });
+                for (size_type k = 0; k < used.size();) {
+                    size_type idx = used[k];
+
+                    if (idx < first || idx >= size)
+                        throw std::runtime_error("Invalid sparse_array snapshot");
+                    page_ptr &page = pages[idx / page_size];
+                    // the run stops at the end of the page, the snapshot may have been written with larger ones
+                    size_type run = 1;
+
+                    while (k + run < used.size() && used[k + run] == idx + run && (idx + run) % page_size != 0)
+                        run++;
+                    if (idx + run > size)
+                        throw std::runtime_error("Invalid sparse_array snapshot");
+                    if (!page) {
+                        page = make_page();
+                        page->base = idx / page_size * page_size;
+                        if constexpr (track_changes_v<Component>) {
+                            page->added.fill(_tick);
+                            page->changed.fill(_tick);
+                        }
+                    }
+                    value_type *slots = page->slots.data() + idx % page_size;
+
+                    if (std::any_of(slots, slots + run, [](value_type const &slot) { return slot.has_value(); }))
+                        throw std::runtime_error("Invalid sparse_array snapshot");
+                    read_slots(reader, slots, run);
+                    page->live += run;
+                    counted += run;
+                    k += run;
+                }
+            }
+            if (counted != live)
+                throw std::runtime_error("Invalid sparse_array snapshot");
+            _pages = std::move(pages);
+            index_pages();
+            _size = size;
+            _live = live;
+            _log.reset(_tick);
+        }
+
+        /**
+         * @brief Set the tick stamped on the next tracked changes, called by the registry at each run_systems.
+         * The change log makes room for the next tick.
+         *
+         * @param tick current tick
+         */
+        void set_tick(tick_t tick)
+        {
+            if constexpr (track_changes_v<Component>)
+                _log.compact(_tick, _live, [this](size_type idx, tick_t last) { return is_last_change(idx, last); });
+            _tick = tick;
+        }
+        /**
+         * @brief Check if the component at a given index was added after a tick. Always false if the changes are not tracked.
+         *
+         * @param idx to check
+         * @param since tick
+         * @return true if it was added after since
+         */
+        bool is_added(size_type idx, tick_t since) const
+        {
+            if constexpr (track_changes_v<Component>)
+                return contains(idx) && _pages[idx / page_size]->added[idx % page_size] > since;
+            (void)idx;
+            (void)since;
+            return false;
+        }
+        /**
+         * @brief Check if the component at a given index was added or mutably accessed after a tick. Always false if the changes are not tracked.
+         *
+         * @param idx to check
+         * @param since tick
+         * @return true if it changed after since
+         */
+        bool is_changed(size_type idx, tick_t since) const
+        {
+            if constexpr (track_changes_v<Component>)
+                return contains(idx) && _pages[idx / page_size]->changed[idx % page_size] > since;
+            (void)idx;
+            (void)since;
+            return false;
+        }
+        /**
+         * @brief Get the indexes of the components added or mutably accessed after a tick, in increasing order.
+         * They are read from the change log, so the cost depends on the number of changes and not on the number of components,
+         * unless the log missed changes (see change_log).
+         *
+         * @param since tick
+         * @return std::vector<size_type>
+         */
+        std::vector<size_type> changes(tick_t since) const
+        {
+            std::vector<size_type> indexes;
+
+            if constexpr (track_changes_v<Component>) {
+                if (_log.covers(since)) {
+                    _log.for_each_since(since, [this, &indexes](size_type idx, tick_t last) {
+                        if (is_last_change(idx, last))
+                            indexes.push_back(idx);
+                    });
+                    std::sort(indexes.begin(), indexes.end());
+                    indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+                    return indexes;
+                }
+                for (size_type i = 0; i < _pages.size(); i++) {
+                    if (!_pages[i])
+                        continue;
+                    for (size_type j = 0; j < page_size; j++) {
+                        if (_pages[i]->changed[j] > since && _pages[i]->slots[j].has_value())
+                            indexes.push_back(i * page_size + j);
+                    }
+                }
+            }
+            return indexes;
+        }
+        /**
+         * @brief Get the indexes of the components removed after a tick, in removal order
+         *
+         * @param since tick
+         * @return std::vector<size_type>
+         */
+        std::vector<size_type> removals(tick_t since) const
+        {
+            std::vector<size_type> indexes;
+            auto first = std::upper_bound(_removed.begin(), _removed.end(), since, [](tick_t t, auto const &r) { return t < r.second; });
+
+            for (auto it = first; it != _removed.end(); ++it)
+                indexes.push_back(it->first);
+            return indexes;
+        }
+        /**
+         * @brief Forget the removals logged up to a tick, once every peer received them
+         *
+         * @param until tick
+         */
+        void trim_removals(tick_t until)
+        {
+            _removed.erase(std::remove_if(_removed.begin(), _removed.end(), [until](auto const &r) { return r.second <= until; }), _removed.end());
         }
 
     private:
-        container_t _data;
+        static size_type page_count(size_type size)
+        {
+            return (size + page_size - 1) / page_size;
+        }
+        template <typename... Args> static page_ptr make_page(Args const &...from)
+        {
+            void *memory = ::operator new(page_bytes, std::align_val_t(page_bytes));
+
+            try {
+                return page_ptr(new (memory) page_t(from...));
+            } catch (...) {
+                ::operator delete(memory, std::align_val_t(page_bytes));
+                throw;
+            }
+        }
+        static std::vector<page_ptr> copy_pages(std::vector<page_ptr> const &from)
+        {
+            std::vector<page_ptr> pages(from.size());
+
+            for (size_type i = 0; i < from.size(); i++) {
+                if (from[i])
+                    pages[i] = make_page(*from[i]);
+            }
+            return pages;
+        }
+        void index_pages()
+        {
+            _page_index.clear();
+            for (size_type i = 0; i < _pages.size(); i++) {
+                if (_pages[i])
+                    _page_index.emplace(reinterpret_cast<std::uintptr_t>(_pages[i].get()), i);
+            }
+        }
+        void grow_table(size_type count)
+        {
+            if (count > _pages.capacity())
+                _resizes++;
+            _pages.resize(count);
+        }
+        value_type const *find_slot(size_type idx) const
+        {
+            size_type i = idx / page_size;
+
+            if (i >= _pages.size() || !_pages[i])
+                return nullptr;
+            return &_pages[i]->slots[idx % page_size];
+        }
+        value_type *find_slot(size_type idx)
+        {
+            return const_cast<value_type *>(std::as_const(*this).find_slot(idx));
+        }
+        value_type const &slot(size_type idx) const
+        {
+            static value_type const empty;
+            value_type const *found = find_slot(idx);
+
+            return found ? *found : empty;
+        }
+        slot_ref slot(size_type idx)
+        {
+            return slot_ref(this, idx);
+        }
+        page_t &page_of(size_type idx)
+        {
+            size_type i = idx / page_size;
+
+            if (i >= _pages.size())
+                grow_table(i + 1);
+            if (!_pages[i]) {
+                _resizes++;
+                _pages[i] = make_page();
+                _pages[i]->base = i * page_size;
+                _page_index.emplace(reinterpret_cast<std::uintptr_t>(_pages[i].get()), i);
+            }
+            return *_pages[i];
+        }
+        template <typename Value> value_type &emplace(size_type pos, Value &&component)
+        {
+            if (pos >= _size)
+                _size = pos + 1;
+            page_t &p = page_of(pos);
+            value_type &slot = p.slots[pos % page_size];
+
+            stamp(p, pos, !slot.has_value());
+            if (!slot.has_value()) {
+                p.live++;
+                _live++;
+            }
+            slot = std::forward<Value>(component);
+            return slot;
+        }
+        void touch(page_t &p, size_type idx)
+        {
+            if constexpr (track_changes_v<Component>) {
+                if (p.changed[idx % page_size] != _tick) {
+                    p.changed[idx % page_size] = _tick;
+                    _log.record_change(idx, _tick);
+                }
+            }
+            (void)p;
+            (void)idx;
+        }
+        void stamp(page_t &p, size_type idx, bool added)
+        {
+            if constexpr (track_changes_v<Component>) {
+                if (added)
+                    p.added[idx % page_size] = _tick;
+                if (p.changed[idx % page_size] != _tick) {
+                    p.changed[idx % page_size] = _tick;
+                    _log.push(idx, _tick);
+                }
+            }
+            (void)p;
+            (void)idx;
+            (void)added;
+        }
+        bool is_last_change(size_type idx, tick_t tick) const
+        {
+            if constexpr (track_changes_v<Component>)
+                return contains(idx) && _pages[idx / page_size]->changed[idx % page_size] == tick;
+            (void)idx;
+            (void)tick;
+            return false;
+        }
+
+        std::vector<page_ptr> _pages;
+        std::unordered_map<std::uintptr_t, size_type> _page_index; /**< index in _pages of each allocated page, by its address */
+        size_type _size = 0;
+        size_type _live = 0;
+        tick_t _tick = 1;
+        std::vector<std::pair<size_type, tick_t>> _removed;
+        change_log _log;
+        size_type _resizes = 0;
     };
 }
 
@@ -0,0 +1,363 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Spatial_grid
+*/
+
+#ifndef SPATIAL_GRID_HPP_
+#define SPATIAL_GRID_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Change_tracking.hpp"
+
+namespace ecs {
+    /**
+     * @brief Axis aligned bounding box
+     *
+     */
+    struct aabb {
+        float min_x;
+        float min_y;
+        float max_x;
+        float max_y;
+
+        /**
+         * @brief Check if two boxes overlap, touching boxes overlap
+         *
+         * @param other box
+         * @return true or false
+         */
+        bool overlaps(aabb const &other) const
+        {
+            return min_x <= other.max_x && other.min_x <= max_x && min_y <= other.max_y && other.min_y <= max_y;
+        }
+    };
+
+    /**
+     * @brief Broadphase index of the boxes of the entities on a uniform grid. Each entity is stored in the cells its box covers,
+     * so a query only tests the entities of the cells it covers. Choose a cell size around the size of the common boxes.
+     * Store it as a resource of the registry and update it from the changed components with sync:
+     * @code
+     * auto &grid = reg.set_resource<ecs::spatial_grid>(32.f);
+     * // in a system
+     * grid.sync(positions, last_tick, [](std::size_t, position const &pos) { return ecs::aabb{pos.x, pos.y, pos.x + 16, pos.y + 16}; });
+     * grid.for_each_overlapping_pair([](std::size_t a, std::size_t b) { ... });
+     * @endcode
+     *
+     */
+    class spatial_grid {
+    public:
+        static constexpr std::int32_t max_cell = 1 << 30; /**< highest cell coordinate, in both directions, so the loops over the cells do not overflow */
+        static constexpr std::uint64_t max_box_cells = 1 << 16; /**< most cells covered by the box of an entity */
+
+        /**
+         * @brief Construct a new spatial grid object
+         *
+         * @param cell_size width and height of a cell, must be positive
+         */
+        explicit spatial_grid(float cell_size) : _cell_size(cell_size), _inv_cell_size(1.f / cell_size)
+        {
+            if (!(cell_size > 0))
+                throw std::runtime_error("spatial_grid: the cell size must be positive");
+        }
+
+        /**
+         * @brief Insert an entity or move it to a new box. Only the cells it leaves or enters are touched.
+         * Throws a std::out_of_range exception if a coordinate of the box is NaN or out of the range of the cells (see max_cell),
+         * if its min is above its max, or if it covers more than max_box_cells cells; the grid is then unchanged.
+         *
+         * @param entity to insert or move
+         * @param box of the entity
+         */
+        void update(std::size_t entity, aabb const &box)
+        {
+            range cells = cells_of(box);
+
+            if (cell_count(cells) > max_box_cells)
+                throw std::out_of_range("spatial_grid: box covering more than max_box_cells cells");
+
+            if (entity >= _entries.size())
+                _entries.resize(entity + 1);
+            entry &e = _entries[entity];
+            if (e.present && e.cells == cells) {
+                e.box = box;
+                return;
+            }
+            if (e.present)
+                unlink(entity, e.cells);
+            else
+                _count++;
+            e.box = box;
+            e.cells = cells;
+            e.present = true;
+            link(entity, cells);
+        }
+        /**
+         * @brief Remove an entity. If it is not in the grid, nothing will happen.
+         *
+         * @param entity to remove
+         */
+        void erase(std::size_t entity)
+        {
+            if (!contains(entity))
+                return;
+            unlink(entity, _entries[entity].cells);
+            _entries[entity].present = false;
+            _count--;
+        }
+        /**
+         * @brief Check if an entity is in the grid
+         *
+         * @param entity to check
+         * @return true or false
+         */
+        bool contains(std::size_t entity) const
+        {
+            return entity < _entries.size() && _entries[entity].present;
+        }
+        /**
+         * @brief Get the box of an entity. Can throw a std::out_of_range exception if the entity is not in the grid.
+         *
+         * @param entity
+         * @return aabb const&
+         */
+        aabb const &box(std::size_t entity) const
+        {
+            if (!contains(entity))
+                throw std::out_of_range("spatial_grid: entity not in the grid");
+            return _entries[entity].box;
+        }
+        /**
+         * @brief Get the number of entities in the grid
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const
+        {
+            return _count;
+        }
+        /**
+         * @brief Get the size of a cell
+         *
+         * @return float
+         */
+        float cell_size() const
+        {
+            return _cell_size;
+        }
+        /**
+         * @brief Remove all the entities
+         *
+         */
+        void clear()
+        {
+            _cells.clear();
+            _entries.clear();
+            _count = 0;
+        }
+
+        /**
+         * @brief Apply the changes of a tracked component made after a tick (see track_changes): the removed components
+         * leave the grid, the added and modified ones are moved to their new box. The changes are read from the logs of
+         * the container, so the cost depends on the number of entities changed since the tick, not on the size of the container.
+         *
+         * @tparam Container sparse_array or packed_array of the component
+         * @tparam Function aabb(std::size_t entity, Component const &)
+         * @param components container of the component giving the box
+         * @param since tick of the previous sync
+         * @param bounds function computing the box of an entity
+         */
+        template <class Container, class Function> void sync(Container const &components, tick_t since, Function &&bounds)
+        {
+            static_assert(track_changes_v<std::decay_t<decltype(components.get(0))>>, "spatial_grid::sync needs a tracked component, use rebuild otherwise");
+
+            for (std::size_t entity : components.removals(since))
+                erase(entity);
+            for (std::size_t entity : components.changes(since))
+                update(entity, bounds(entity, components.get(entity)));
+        }
+        /**
+         * @brief Replace the content of the grid by the boxes of all the entities having a component
+         *
+         * @tparam Container of the component
+         * @tparam Function aabb(std::size_t entity, Component const &)
+         * @param components container of the component giving the box
+         * @param bounds function computing the box of an entity
+         */
+        template <class Container, class Function> void rebuild(Container const &components, Function &&bounds)
+        {
+            clear();
+            for (std::size_t pos = 0; pos < components.scan_size(); pos++) {
+                std::size_t entity = components.scan_index(pos);
+
+                if (entity != Container::npos)
+                    update(entity, bounds(entity, components.get(entity)));
+            }
+        }
+
+        /**
+         * @brief Call a function on each entity whose box overlaps a box, once per entity. A box covering more cells than
+         * the grid uses visits the used cells instead of the covered ones.
+         * Throws a std::out_of_range exception if a coordinate of the box is NaN or out of range, or if its min is above its max.
+         *
+         * @tparam Function void(std::size_t entity)
+         * @param box to test
+         * @param f function called with the overlapping entities
+         */
+        template <class Function> void query_aabb(aabb const &box, Function &&f) const
+        {
+            range query = cells_of(box);
+            auto visit = [this, &query, &box, &f](std::int32_t x, std::int32_t y, std::vector<std::size_t> const &entities) {
+                for (std::size_t entity : entities) {
+                    entry const &e = _entries[entity];
+
+                    // an entity covering several cells is only reported by the first one shared with the query
+                    if (x == std::max(e.cells.min_x, query.min_x) && y == std::max(e.cells.min_y, query.min_y) && e.box.overlaps(box))
+                        f(entity);
+                }
+            };
+
+            if (cell_count(query) > _cells.size()) {
+                for (auto const &[cell_key, entities] : _cells) {
+                    std::int32_t x = static_cast<std::int32_t>(cell_key >> 32);
+                    std::int32_t y = static_cast<std::int32_t>(cell_key & 0xFFFFFFFF);
+
+                    if (x >= query.min_x && x <= query.max_x && y >= query.min_y && y <= query.max_y)
+                        visit(x, y, entities);
+                }
+                return;
+            }
+            for (std::int32_t y = query.min_y; y <= query.max_y; y++) {
+                for (std::int32_t x = query.min_x; x <= query.max_x; x++) {
+                    auto cell = _cells.find(key(x, y));
+
+                    if (cell != _cells.end())
+                        visit(x, y, cell->second);
+                }
+            }
+        }
+        /**
+         * @brief Get the entities whose box overlaps a box
+         *
+         * @param box to test
+         * @return std::vector<std::size_t>
+         */
+        std::vector<std::size_t> query_aabb(aabb const &box) const
+        {
+            std::vector<std::size_t> found;
+
+            query_aabb(box, [&found](std::size_t entity) { found.push_back(entity); });
+            return found;
+        }
+        /**
+         * @brief Call a function on each pair of entities whose boxes overlap, once per pair
+         *
+         * @tparam Function void(std::size_t a, std::size_t b)
+         * @param f function called with the two entities
+         */
+        template <class Function> void for_each_overlapping_pair(Function &&f) const
+        {
+            for (auto const &[cell_key, entities] : _cells) {
+                std::int32_t x = static_cast<std::int32_t>(cell_key >> 32);
+                std::int32_t y = static_cast<std::int32_t>(cell_key & 0xFFFFFFFF);
+
+                for (std::size_t i = 0; i < entities.size(); i++) {
+                    entry const &a = _entries[entities[i]];
+
+                    for (std::size_t j = i + 1; j < entities.size(); j++) {
+                        entry const &b = _entries[entities[j]];
+
+                        // a pair sharing several cells is only reported by the first one
+                        if (x == std::max(a.cells.min_x, b.cells.min_x) && y == std::max(a.cells.min_y, b.cells.min_y) && a.box.overlaps(b.box))
+                            f(entities[i], entities[j]);
+                    }
+                }
+            }
+        }
+
+    private:
+        struct range {
+            std::int32_t min_x = 0;
+            std::int32_t min_y = 0;
+            std::int32_t max_x = -1;
+            std::int32_t max_y = -1;
+
+            bool operator==(range const &other) const
+            {
+                return min_x == other.min_x && min_y == other.min_y && max_x == other.max_x && max_y == other.max_y;
+            }
+        };
+        struct entry {
+            aabb box{};
+            range cells;
+            bool present = false;
+        };
+
+        static std::uint64_t key(std::int32_t x, std::int32_t y)
+        {
+            return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) | static_cast<std::uint32_t>(y);
+        }
+        std::int32_t cell_of(float v) const
+        {
+            float cell = std::floor(v * _inv_cell_size);
+
+            // also false for NaN
+            if (!(cell >= -static_cast<float>(max_cell) && cell <= static_cast<float>(max_cell)))
+                throw std::out_of_range("spatial_grid: box coordinate out of the range of the grid");
+            return static_cast<std::int32_t>(cell);
+        }
+        range cells_of(aabb const &box) const
+        {
+            range cells{cell_of(box.min_x), cell_of(box.min_y), cell_of(box.max_x), cell_of(box.max_y)};
+
+            // an inverted box would cover no cell, its entity could never be found
+            if (box.min_x > box.max_x || box.min_y > box.max_y)
+                throw std::out_of_range("spatial_grid: box min above its max");
+            return cells;
+        }
+        static std::uint64_t cell_count(range const &cells)
+        {
+            // a side spans up to 2 * max_cell + 1 cells, above the range of std::int32_t
+            std::uint64_t width = static_cast<std::uint64_t>(static_cast<std::int64_t>(cells.max_x) - cells.min_x + 1);
+            std::uint64_t height = static_cast<std::uint64_t>(static_cast<std::int64_t>(cells.max_y) - cells.min_y + 1);
+
+            return width * height;
+        }
+        void link(std::size_t entity, range const &cells)
+        {
+            for (std::int32_t y = cells.min_y; y <= cells.max_y; y++) {
+                for (std::int32_t x = cells.min_x; x <= cells.max_x; x++)
+                    _cells[key(x, y)].push_back(entity);
+            }
+        }
+        void unlink(std::size_t entity, range const &cells)
+        {
+            for (std::int32_t y = cells.min_y; y <= cells.max_y; y++) {
+                for (std::int32_t x = cells.min_x; x <= cells.max_x; x++) {
+                    auto cell = _cells.find(key(x, y));
+                    auto &entities = cell->second;
+
+                    *std::find(entities.begin(), entities.end(), entity) = entities.back();
+                    entities.pop_back();
+                    if (entities.empty())
+                        _cells.erase(cell);
+                }
+            }
+        }
+
+        float _cell_size;
+        float _inv_cell_size;
+        std::unordered_map<std::uint64_t, std::vector<std::size_t>> _cells;
+        std::vector<entry> _entries;
+        std::size_t _count = 0;
+    };
+}
+
+#endif /* !SPATIAL_GRID_HPP_ */
@@ -0,0 +1,213 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Thread_pool
+*/
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ecs {
+    /**
+     * @brief Fixed size pool of worker threads with work stealing.
+     * Each worker has its own queue, tasks submitted by a worker go to its queue and idle workers steal from the others.
+     * A thread waiting for tasks with wait_until runs pending tasks meanwhile, so tasks can wait for other tasks.
+     * Submitting and taking a task only lock the queue it goes through, the pool mutex is only taken to put an idle worker
+     * to sleep and to wake it up.
+     *
+     */
+    class thread_pool {
+    public:
+        using task = std::function<void()>;
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1); /**< worker index of a thread outside the pool */
+
+        /**
+         * @brief Construct a new thread pool object
+         *
+         * @param workers number of threads, at least 1
+         */
+        explicit thread_pool(std::size_t workers = std::thread::hardware_concurrency())
+        {
+            workers = std::max<std::size_t>(workers, 1);
+            for (std::size_t i = 0; i < workers; i++)
+                _queues.push_back(std::make_unique<queue>());
+            for (std::size_t i = 0; i < workers; i++)
+                _threads.emplace_back([this, i]() { work(i); });
+        }
+        thread_pool(thread_pool const &) = delete;
+        thread_pool &operator=(thread_pool const &) = delete;
+        /**
+         * @brief Destroy the thread pool object, run the remaining tasks and join the threads
+         *
+         */
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _cv.notify_all();
+            for (auto &thread : _threads)
+                thread.join();
+        }
+
+        /**
+         * @brief Get the number of workers
+         *
+         * @return std::size_t
+         */
+        std::size_t size() const
+        {
+            return _threads.size();
+        }
+        /**
+         * @brief Get the index of the worker running the calling thread
+         *
+         * @return std::size_t index, or npos if the thread is not a worker of this pool
+         */
+        std::size_t current_worker() const
+        {
+            return _current_pool == this ? _current_index : npos;
+        }
+        /**
+         * @brief Submit a task. From a worker it goes to its own queue, otherwise the queues are filled in turn.
+         *
+         * @param t task to run
+         */
+        void submit(task t)
+        {
+            std::size_t index = current_worker();
+
+            if (index == npos)
+                index = _next++ % _queues.size();
+            {
+                // the task is counted before a take can find it, take decrements _pending under the same lock
+                std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+                _queues[index]->tasks.push_back(std::move(t));
+                _pending++;
+            }
+            // a worker counts itself in _sleeping before reading _pending, so either it sees the task or it is seen here
+            if (_sleeping > 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _cv.notify_one();
+            }
+        }
+        /**
+         * @brief Run one pending task on the calling thread
+         *
+         * @return true if a task was run
+         */
+        bool run_pending_task()
+        {
+            task t;
+
+            if (!take(current_worker(), t))
+                return false;
+            t();
+            return true;
+        }
+        /**
+         * @brief Run pending tasks until a condition is met
+         *
+         * @tparam Predicate
+         * @param done condition to wait for
+         */
+        template <typename Predicate> void wait_until(Predicate &&done)
+        {
+            while (!done()) {
+                if (!run_pending_task())
+                    std::this_thread::yield();
+            }
+        }
+
+        /**
+         * @brief Get the pool shared by the whole process, it has one worker per hardware thread
+         *
+         * @return thread_pool&
+         */
+        static thread_pool &shared()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+    private:
+        struct queue {
+            std::mutex mutex;
+            std::deque<task> tasks;
+        };
+
+        bool take(std::size_t index, task &t)
+        {
+            std::size_t count = _queues.size();
+
+            if (index != npos) {
+                std::lock_guard<std::mutex> lock(_queues[index]->mutex);
+                if (!_queues[index]->tasks.empty()) {
+                    t = std::move(_queues[index]->tasks.back());
+                    _queues[index]->tasks.pop_back();
+                    _pending--;
+                    return true;
+                }
+            }
+            for (std::size_t i = 0; i < count; i++) {
+                std::size_t victim = (index == npos ? i : index + 1 + i) % count;
+                std::lock_guard<std::mutex> lock(_queues[victim]->mutex);
+
+                if (!_queues[victim]->tasks.empty()) {
+                    t = std::move(_queues[victim]->tasks.front());
+                    _queues[victim]->tasks.pop_front();
+                    _pending--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(std::size_t index)
+        {
+            _current_pool = this;
+            _current_index = index;
+            while (true) {
+                task t;
+
+                if (take(index, t)) {
+                    t();
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                _sleeping++;
+                _cv.wait(lock, [this]() { return _stop || _pending > 0; });
+                _sleeping--;
+                if (_stop && _pending == 0)
+                    return;
+            }
+        }
+
+    private:
+        std::vector<std::unique_ptr<queue>> _queues;
+        std::vector<std::thread> _threads;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::atomic<std::size_t> _pending{0}; /**< tasks in the queues, only changed under the lock of a queue */
+        std::atomic<std::size_t> _sleeping{0}; /**< workers waiting on _cv, only changed under _mutex */
+        std::atomic<std::size_t> _next{0};
+        bool _stop = false;
+        static inline thread_local thread_pool const *_current_pool = nullptr;
+        static inline thread_local std::size_t _current_index = npos;
+    };
+}
+
+#endif /* !THREAD_POOL_HPP_ */
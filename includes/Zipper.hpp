@@ -13,52 +13,109 @@
 
 namespace ecs {
     /**
-     * @brief Zipper helper class to iterate over multiple containers at the same time and only stop when an entity have all the components specified
-     * 
-     * @tparam Containers 
+     * @brief Zipper helper class to iterate over multiple containers at the same time and only stop when an entity have all the components specified.
+     * The container with the shortest walk drives the iteration, the others are only probed for the entities it holds.
+     * A packed container walks its live components, a sparse_array walks its whole index range.
+     * Filters like without can be given along the containers, they reject entities but do not give a component.
+     *
+     * @tparam Containers
      */
     template <class ...Containers>
     class zipper {
+        static_assert(!(detail::zipper_term<Containers>::is_filter && ...), "A zipper needs at least one container");
         public:
             using iterator = zipper_iterator<Containers...>;
-            using iterator_tuple = typename iterator::iterator_tuple;
+            using term_tuple = typename iterator::term_tuple;
 
             /**
              * @brief Construct a new zipper object
-             * 
-             * @param cs all the containers to iterate over
+             *
+             * @param cs all the containers and filters to iterate over
              */
-            zipper(Containers &...cs) : _size(_compute_size(cs...)), _begin(std::make_tuple(cs.begin()...)), _end(_compute_end(cs...)) {
+            zipper(typename detail::zipper_term<Containers>::argument ...cs)
+                : _terms(detail::zipper_term<Containers>::store(cs)...), _driver(_compute_driver(_seq)), _size(_compute_size(_seq)) {
             };
 
             /**
              * @brief Get the begin iterator
-             * 
-             * @return iterator 
+             *
+             * @return iterator
              */
             iterator begin() {
-                return iterator(_begin, _size);
+                return iterator(_terms, _driver, 0, _size);
             }
             /**
              * @brief Get the end iterator
-             * 
-             * @return iterator 
+             *
+             * @return iterator
              */
             iterator end() {
-                return iterator(_end, 0);
+                return iterator(_terms, _driver, _size, _size);
+            }
+            /**
+             * @brief Get the number of positions walked by the container driving the iteration
+             *
+             * @return std::size_t
+             */
+            std::size_t size() const {
+                return _size;
+            }
+            /**
+             * @brief Get an iterator on the entities found between two positions of the walk, used to split the iteration
+             *
+             * @param from first position of the walk
+             * @param to position where the iteration stops
+             * @return iterator
+             */
+            iterator begin(std::size_t from, std::size_t to) {
+                return iterator(_terms, _driver, std::min(from, to), to);
+            }
+            /**
+             * @brief Get the end iterator of a part of the walk
+             *
+             * @param to position where the iteration stops
+             * @return iterator
+             */
+            iterator end(std::size_t to) {
+                return iterator(_terms, _driver, to, to);
             }
 
         private:
-            static size_t _compute_size(Containers &...containers) {
-                return std::min({containers.size()...});
-            };
-            static iterator_tuple _compute_end(Containers &...containers) {
-                return std::make_tuple(containers.begin() + _compute_size(containers...) ...);
+            template <size_t I>
+            std::size_t _scan_size() const {
+                if constexpr (detail::zipper_term<std::tuple_element_t<I, std::tuple<Containers...>>>::is_filter)
+                    return 0;
+                else
+                    return std::get<I>(_terms)->scan_size();
+            }
+            template <size_t I>
+            std::size_t _walk_cost() const {
+                if constexpr (detail::zipper_term<std::tuple_element_t<I, std::tuple<Containers...>>>::is_filter)
+                    return static_cast<std::size_t>(-1);
+                else
+                    return _scan_size<I>();
+            }
+            template <size_t... Is>
+            std::size_t _compute_driver(std::index_sequence<Is...>) const {
+                std::size_t costs[] = {_walk_cost<Is>()...};
+
+                return std::distance(std::begin(costs), std::min_element(std::begin(costs), std::end(costs)));
+            }
+            template <size_t... Is>
+            std::size_t _compute_size(std::index_sequence<Is...>) const {
+                std::size_t size = 0;
+
+                (void)((Is == _driver ? (size = _scan_size<Is>(), true) : false) || ...);
+                return size;
             }
         private:
-            size_t _size;
-            iterator_tuple _begin;
-            iterator_tuple _end;
+            term_tuple _terms;
+            std::size_t _driver;
+            std::size_t _size;
+            static constexpr std::index_sequence_for<Containers...> _seq{};
     };
+
+    template <class ...Containers>
+    zipper(Containers &&...) -> zipper<std::remove_reference_t<Containers>...>;
 }
 #endif /* !ZIPPER_HPP_ */
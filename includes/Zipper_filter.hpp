@@ -0,0 +1,169 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Zipper_filter
+*/
+
+#ifndef ZIPPER_FILTER_HPP_
+#define ZIPPER_FILTER_HPP_
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+#include "Change_tracking.hpp"
+
+namespace ecs {
+    /**
+     * @brief Filter of a zipper, only keep the entities that do not have a component
+     * @code
+     * for (auto [id, pos, vel] : ecs::zipper(positions, velocities, ecs::without(frozens)))
+     * @endcode
+     *
+     * @tparam Container of the excluded component
+     */
+    template <class Container> class without {
+    public:
+        /**
+         * @brief Construct a new without object
+         *
+         * @param container of the excluded component
+         */
+        explicit without(Container &container) : _container(&container) {}
+
+        /**
+         * @brief Check if an entity passes the filter
+         *
+         * @param idx entity to check
+         * @return true if the entity does not have the component
+         */
+        bool accept(std::size_t idx) const
+        {
+            return !_container->contains(idx);
+        }
+
+    private:
+        Container *_container;
+    };
+
+    /**
+     * @brief Filter of a zipper, only keep the entities whose component was added after a tick.
+     * The component must have its changes tracked, see track_changes.
+     * @code
+     * for (auto [id, pos] : ecs::zipper(positions, ecs::added(positions, last_tick)))
+     * @endcode
+     *
+     * @tparam Container of the tracked component
+     */
+    template <class Container> class added {
+    public:
+        /**
+         * @brief Construct a new added object
+         *
+         * @param container of the tracked component
+         * @param since tick, the components added at this tick or before are rejected
+         */
+        added(Container &container, tick_t since) : _container(&container), _since(since) {}
+
+        /**
+         * @brief Check if an entity passes the filter
+         *
+         * @param idx entity to check
+         * @return true if the component of the entity was added after the tick
+         */
+        bool accept(std::size_t idx) const
+        {
+            return _container->is_added(idx, _since);
+        }
+
+    private:
+        Container *_container;
+        tick_t _since;
+    };
+
+    /**
+     * @brief Filter of a zipper, only keep the entities whose component was added or mutably accessed after a tick.
+     * The component must have its changes tracked, see track_changes.
+     * @code
+     * for (auto [id, pos] : ecs::zipper(std::as_const(positions), ecs::changed(positions, last_tick)))
+     * @endcode
+     *
+     * @tparam Container of the tracked component
+     */
+    template <class Container> class changed {
+    public:
+        /**
+         * @brief Construct a new changed object
+         *
+         * @param container of the tracked component
+         * @param since tick, the components changed at this tick or before are rejected
+         */
+        changed(Container &container, tick_t since) : _container(&container), _since(since) {}
+
+        /**
+         * @brief Check if an entity passes the filter
+         *
+         * @param idx entity to check
+         * @return true if the component of the entity changed after the tick
+         */
+        bool accept(std::size_t idx) const
+        {
+            return _container->is_changed(idx, _since);
+        }
+
+    private:
+        Container *_container;
+        tick_t _since;
+    };
+
+    namespace detail {
+        /**
+         * @brief Describe how a zipper uses one of its arguments. A container can drive the iteration and gives a component,
+         * a filter only rejects entities.
+         *
+         * @tparam Term container or filter given to the zipper
+         */
+        template <class Term> struct zipper_term {
+            using storage = Term *;
+            using argument = Term &;
+            using value_tuple = std::tuple<decltype(std::declval<Term &>().get(0))>;
+            static constexpr bool is_filter = false;
+
+            static storage store(argument container)
+            {
+                return &container;
+            }
+            static bool accept(storage const &container, std::size_t idx)
+            {
+                return container->contains(idx);
+            }
+        };
+
+        /**
+         * @brief Describe a filter given to a zipper, it is stored by value and gives no component
+         *
+         * @tparam Filter
+         */
+        template <class Filter> struct zipper_filter_term {
+            using storage = Filter;
+            using argument = Filter;
+            using value_tuple = std::tuple<>;
+            static constexpr bool is_filter = true;
+
+            static storage store(argument filter)
+            {
+                return filter;
+            }
+            static bool accept(storage const &filter, std::size_t idx)
+            {
+                return filter.accept(idx);
+            }
+        };
+
+        template <class Container> struct zipper_term<without<Container>> : zipper_filter_term<without<Container>> {};
+        template <class Container> struct zipper_term<added<Container>> : zipper_filter_term<added<Container>> {};
+        template <class Container> struct zipper_term<changed<Container>> : zipper_filter_term<changed<Container>> {};
+    }
+}
+
+#endif /* !ZIPPER_FILTER_HPP_ */
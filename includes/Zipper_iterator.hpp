@@ -10,62 +10,71 @@
 
 #include <tuple>
 #include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include "Zipper_filter.hpp"
+#ifdef ECS_PROFILING
+#include "Profiler.hpp"
+#endif
 
 namespace ecs {
     template<class ...Containers> class zipper;
 
     /**
-     * @brief Iterator class for the zipper class
-     * 
-     * @tparam Containers 
+     * @brief Iterator class for the zipper class. It walks the container chosen to drive the iteration
+     * and probes the others for each entity found.
+     *
+     * @tparam Containers
      */
     template<class ...Containers>
     class zipper_iterator {
-        template <class Container>
-        using iterator_t = decltype(std::declval<Container>().begin());
-        template <class Container>
-        using it_reference_t = typename iterator_t<Container>::reference;
     public:
-        using value_type = std::tuple<std::size_t, decltype(std::declval<it_reference_t<Containers>>().value()) &...>;
+        using value_type = decltype(std::tuple_cat(std::declval<std::tuple<std::size_t>>(), std::declval<typename detail::zipper_term<Containers>::value_tuple>()...));
         using reference = value_type;
         using pointer = void;
         using difference_type = size_t;
         using iterator_category = std::forward_iterator_tag;
-        using iterator_tuple = std::tuple<iterator_t<Containers>...>;
+        using term_tuple = std::tuple<typename detail::zipper_term<Containers>::storage...>;
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1); /**< index of a position without entity */
 
         friend class zipper<Containers...>;
     private:
         /**
          * @brief Construct a new zipper iterator object
-         * 
-         * @param it_tuple tuple of iterators of the containers
-         * @param max index of the last element
+         *
+         * @param terms containers and filters of the zipper
+         * @param driver position of the container driving the iteration
+         * @param pos position in the walk of the driver
+         * @param max end of the walk of the driver
          */
-        zipper_iterator(iterator_tuple const &it_tuple, size_t max) : _current(it_tuple), _max(max), _idx(0) {
-            if(_max && !all_set(_seq)) {
-                incr_all(_seq);
-            }
+        zipper_iterator(term_tuple const &terms, std::size_t driver, std::size_t pos, std::size_t max)
+            : _terms(terms), _driver(driver), _pos(pos), _max(max), _idx(npos) {
+            seek(_seq);
         }
     public:
         /**
          * @brief Copy construct a new zipper iterator object
-         * 
+         *
          * @param z object to copy
          */
         zipper_iterator(zipper_iterator const &z) = default;
         /**
          * @brief Overload of the ++ operator. Increment the iterator, then return it
-         * 
-         * @return zipper_iterator& 
+         *
+         * @return zipper_iterator&
          */
         zipper_iterator &operator++() {
-            incr_all(_seq);
+            if (_pos < _max) {
+                _pos++;
+                seek(_seq);
+            }
             return *this;
         }
         /**
          * @brief Overload of the ++ operator. Return the iterator, then increment it
-         * 
-         * @return zipper_iterator 
+         *
+         * @return zipper_iterator
          */
         zipper_iterator operator++(int) {
             zipper_iterator tmp(*this);
@@ -74,26 +83,29 @@ namespace ecs {
         }
         /**
          * @brief dereference the iterator
-         * 
-         * @return value_type 
+         *
+         * @return value_type
          */
         value_type operator*() {
+#ifdef ECS_PROFILING
+            detail::iterated_entities++;
+#endif
             return to_value(_seq);
         }
         /**
          * @brief Overload of the == operator. Compare two iterators
-         * 
+         *
          * @param lhs first iterator
          * @param rhs second iterator
          * @return true if the iterators are equal
          * @return false otherwise
          */
         friend bool operator==(zipper_iterator const &lhs, zipper_iterator const &rhs) {
-            return lhs._current == rhs._current;
+            return lhs._pos == rhs._pos;
         }
         /**
          * @brief Overload of the != operator. Compare two iterators
-         * 
+         *
          * @param lhs first iterator
          * @param rhs second iterator
          * @return true if the iterators are not equal
@@ -105,32 +117,57 @@ namespace ecs {
 
     private:
         template<size_t... Is>
-        void incr_all(std::index_sequence<Is...> seq) {
-            (void)seq;
-            if (_idx >= _max)
-                return;
-            _idx++;
-            (std::get<Is>(_current)++, ...);
+        void seek(std::index_sequence<Is...> seq) {
+            for (; _pos < _max; _pos++) {
+                _idx = driver_index(_pos, seq);
+                if (_idx != npos && all_set(seq))
+                    return;
+            }
+        }
+        template<size_t I>
+        std::size_t scan_index(std::size_t pos) const {
+            using term = std::tuple_element_t<I, std::tuple<Containers...>>;
 
-            while(_idx < _max && !all_set(seq)) {
-                _idx++;
-                (std::get<Is>(_current)++, ...);
+            if constexpr (detail::zipper_term<term>::is_filter) {
+                (void)pos;
+                return npos;
+            } else {
+                return std::get<I>(_terms)->scan_index(pos);
             }
         }
         template<size_t... Is>
-        bool all_set(std::index_sequence<Is...> seq) {
+        std::size_t driver_index(std::size_t pos, std::index_sequence<Is...> seq) const {
             (void)seq;
-            return ((std::get<Is>(_current))->has_value() && ...);
+            std::size_t idx = npos;
+
+            (void)((Is == _driver ? (idx = scan_index<Is>(pos), true) : false) || ...);
+            return idx;
+        }
+        template<size_t... Is>
+        bool all_set(std::index_sequence<Is...> seq) const {
+            (void)seq;
+            return ((Is == _driver || detail::zipper_term<Containers>::accept(std::get<Is>(_terms), _idx)) && ...);
+        }
+        template<size_t I>
+        auto value_at() {
+            using term = std::tuple_element_t<I, std::tuple<Containers...>>;
+
+            if constexpr (detail::zipper_term<term>::is_filter)
+                return std::tuple<>();
+            else
+                return typename detail::zipper_term<term>::value_tuple(std::get<I>(_terms)->get(_idx));
         }
         template<size_t... Is>
         value_type to_value(std::index_sequence<Is...> seq) {
             (void)seq;
-            return std::tie(_idx, (std::get<Is>(_current))->value()...);
-        };
+            return std::tuple_cat(std::tuple<std::size_t>(_idx), value_at<Is>()...);
+        }
     private:
-        iterator_tuple _current;
-        size_t _max;
-        size_t _idx;
+        term_tuple _terms;
+        std::size_t _driver;
+        std::size_t _pos;
+        std::size_t _max;
+        std::size_t _idx;
         static constexpr std::index_sequence_for<Containers...> _seq{};
     };
 }
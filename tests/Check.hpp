@@ -0,0 +1,45 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Check
+*/
+
+#ifndef CHECK_HPP_
+#define CHECK_HPP_
+
+#include <cstdio>
+
+namespace check {
+    /**
+     * @brief Number of failed checks, returned by the main of the tests
+     *
+     * @return int&
+     */
+    inline int &failures()
+    {
+        static int count = 0;
+
+        return count;
+    }
+
+    /**
+     * @brief Record a check, print it when it fails. Unlike assert it is also evaluated in release builds.
+     *
+     * @param ok result of the check
+     * @param expr text of the check
+     * @param file where the check is
+     * @param line where the check is
+     */
+    inline void record(bool ok, char const *expr, char const *file, int line)
+    {
+        if (ok)
+            return;
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expr);
+        failures()++;
+    }
+}
+
+#define CHECK(expr) check::record(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+#endif /* !CHECK_HPP_ */
@@ -0,0 +1,16 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** Module_components
+*/
+
+#ifndef MODULE_COMPONENTS_HPP_
+#define MODULE_COMPONENTS_HPP_
+
+// Components shared by the modules test and the module it loads
+
+struct position { float x, y; };
+struct health { int value; };
+
+#endif /* !MODULE_COMPONENTS_HPP_ */
@@ -0,0 +1,115 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** archetype test
+*/
+
+// Tests of the archetype storage: entities move between the tables with their components when they gain or lose one,
+// the rows left behind are filled by the last entity of the table, and each only visits the matching tables.
+
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { int x; };
+    struct velocity { int x; };
+    struct name { std::string value; };
+    struct score { int points; };
+}
+
+template <> struct ecs::component_storage<position> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<velocity> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<name> { using type = ecs::archetype_storage; };
+
+namespace {
+    std::size_t non_empty_tables(ecs::registry &reg)
+    {
+        std::size_t count = 0;
+
+        for (auto const &table : reg.archetypes().tables())
+            count += table->size() != 0;
+        return count;
+    }
+
+    void move_between_tables()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.register_component<name>();
+        reg.register_component<score>();
+        for (int i = 0; i < 6; i++) {
+            entities.push_back(reg.spawn_entity());
+            reg.add_component(entities.back(), position{i});
+            reg.add_component(entities.back(), name{"entity " + std::to_string(i)});
+            if (i % 2)
+                reg.add_component(entities.back(), velocity{i * 10});
+            reg.add_component(entities.back(), score{i});
+        }
+        CHECK(non_empty_tables(reg) == 2);
+
+        // the first row of its table is left, the last entity of the table fills it
+        reg.remove_component<velocity>(entities[1]);
+        reg.add_component(entities[2], velocity{20});
+        reg.remove_component<name>(entities[4]);
+
+        auto &storage = reg.archetypes();
+
+        for (int i = 0; i < 6; i++) {
+            std::size_t idx = entities[i].index();
+
+            CHECK(storage.get<position>(idx).x == i);
+            CHECK(reg.get_components<score>().get(idx).points == i);
+            CHECK(storage.contains<name>(idx) == (i != 4));
+            if (i != 4)
+                CHECK(storage.get<name>(idx).value == "entity " + std::to_string(i));
+            CHECK(storage.contains<velocity>(idx) == (i == 2 || i == 3 || i == 5));
+            if (storage.contains<velocity>(idx))
+                CHECK(storage.get<velocity>(idx).x == i * 10);
+        }
+        CHECK(non_empty_tables(reg) == 3);
+
+        reg.kill_entity(entities[3]);
+        CHECK(!storage.contains<position>(entities[3].index()) && !storage.contains<velocity>(entities[3].index()));
+        CHECK(storage.get<velocity>(entities[5].index()).x == 50 && storage.get<name>(entities[5].index()).value == "entity 5");
+    }
+
+    void each_matching()
+    {
+        ecs::registry reg;
+        std::vector<std::size_t> moved;
+        int total = 0;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.register_component<name>();
+        for (int i = 0; i < 10; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{0});
+            if (i % 3 == 0)
+                reg.add_component(e, velocity{i});
+            if (i % 2 == 0)
+                reg.add_component(e, name{"n"});
+        }
+        reg.archetypes().each<position, const velocity>([&moved](std::size_t id, position &pos, velocity const &vel) {
+            pos.x += vel.x;
+            moved.push_back(id);
+        });
+        CHECK(moved.size() == 4);
+        reg.archetypes().each<position>([&total](std::size_t, position const &pos) { total += pos.x; });
+        CHECK(total == 0 + 3 + 6 + 9);
+    }
+}
+
+int main()
+{
+    move_between_tables();
+    each_matching();
+    return check::failures() ? 1 : 0;
+}
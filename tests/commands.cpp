@@ -0,0 +1,93 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** commands test
+*/
+
+// Tests of the command buffers: order of the operations recorded in one buffer, kills of every buffer applied after the
+// components changes of the others, pools grown once per flush.
+
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { int x; };
+    struct velocity { int x; };
+    struct tag { int v; };
+}
+
+template <> struct ecs::component_storage<tag> { using type = ecs::packed_array<tag>; };
+
+namespace {
+    void one_buffer()
+    {
+        ecs::registry reg;
+        ecs::entity kept = reg.spawn_entity();
+
+        reg.register_component<tag>();
+        auto &commands = reg.commands();
+        ecs::entity spawned = commands.spawn_entity();
+
+        commands.add_component(spawned, tag{1});
+        commands.add_component(kept, tag{2});
+        commands.remove_component<tag>(kept);
+        commands.remove_component<tag>(spawned);
+        commands.add_component(spawned, tag{3});
+        CHECK(!commands.empty());
+        reg.flush_commands();
+        CHECK(commands.empty());
+        CHECK(reg.alive(spawned) && reg.has_component<tag>(spawned));
+        CHECK(reg.get_components<tag>().get(spawned).v == 3);
+        CHECK(!reg.has_component<tag>(kept));
+    }
+
+    void across_buffers()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.register_component<tag>();
+        for (int i = 0; i < 1000; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{i});
+            reg.add_component(e, velocity{i});
+            entities.push_back(e);
+        }
+        ecs::entity target = entities[0];
+
+        reg.set_parallel_systems(2);
+        // the systems only read their components, so they run at the same time with the command buffers of their threads
+        reg.add_system<position const>("killer", [target](ecs::registry &r, std::vector<ecs::entity> &, auto const &) {
+            r.commands().kill_entity(target);
+        });
+        reg.add_system<velocity const>("tagger", [](ecs::registry &r, std::vector<ecs::entity> &all, auto const &) {
+            for (std::size_t i = 0; i < all.size() / 2; i++)
+                r.commands().add_component(all[i], tag{1});
+        });
+        reg.add_system<position const>("second tagger", [](ecs::registry &r, std::vector<ecs::entity> &all, auto const &) {
+            for (std::size_t i = all.size() / 2; i < all.size(); i++)
+                r.commands().add_component(all[i], tag{1});
+        });
+        reg.get_components<tag>().reset_resize_count();
+        reg.run_systems(entities);
+        CHECK(reg.get_components<tag>().resize_count() == 1);
+        CHECK(!reg.alive(target));
+        CHECK(reg.get_components<tag>().live_count() == entities.size() - 1);
+
+        ecs::entity reused = reg.spawn_entity();
+
+        CHECK(reused.index() == target.index());
+        CHECK(!reg.has_component<tag>(reused));
+    }
+}
+
+int main()
+{
+    one_buffer();
+    across_buffers();
+    return check::failures() ? 1 : 0;
+}
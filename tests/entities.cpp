@@ -0,0 +1,215 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** entities test
+*/
+
+// Tests of the entity handles: generations of the reused indexes, indexes that do not fit in a handle, dead handles
+// rejected by the structural changes, signatures following the components and emptied by kill_entity, batches of
+// entities and of components.
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct tag { int v; };
+    struct position { int x; };
+    struct hitbox { int w; };
+    struct sprite { int id; };
+}
+
+template <> struct ecs::component_storage<hitbox> { using type = ecs::packed_array<hitbox>; };
+template <> struct ecs::component_storage<sprite> { using type = ecs::archetype_storage; };
+
+namespace {
+
+    void reused_index()
+    {
+        ecs::registry reg;
+        ecs::entity first = reg.spawn_entity();
+
+        reg.kill_entity(first);
+        ecs::entity second = reg.spawn_entity();
+
+        CHECK(second.index() == first.index());
+        CHECK(second != first);
+        CHECK(!reg.alive(first) && reg.alive(second));
+        CHECK(reg.entity_from_index(first.index()) == second);
+        CHECK(reg.entity_from_handle(second.handle()) == second);
+    }
+
+    void index_out_of_range()
+    {
+        ecs::registry reg;
+        bool thrown = false;
+
+        CHECK(reg.entity_from_index(ecs::entity::index_mask).index() == ecs::entity::index_mask);
+        try {
+            reg.entity_from_index(std::size_t(ecs::entity::index_mask) + 1);
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    void dead_handle()
+    {
+        ecs::registry reg;
+        bool thrown = false;
+
+        reg.register_component<tag>();
+        ecs::entity dead = reg.spawn_entity();
+
+        reg.kill_entity(dead);
+        try {
+            reg.add_component(dead, tag{1});
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+
+        ecs::entity reused = reg.spawn_entity();
+
+        CHECK(reused.index() == dead.index());
+        CHECK(!reg.has_component<tag>(reused));
+        reg.add_component(reused, tag{2});
+        reg.remove_component<tag>(dead);
+        reg.kill_entity(dead);
+        CHECK(reg.alive(reused) && reg.has_component<tag>(reused));
+
+        std::vector<ecs::entity> batch{reused, dead};
+
+        thrown = false;
+        try {
+            reg.add_components<tag>(batch, std::vector<tag>{tag{3}, tag{4}});
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown && reg.get_components<tag>().get(reused).v == 2);
+    }
+
+    void dead_handle_in_commands()
+    {
+        ecs::registry reg;
+
+        reg.register_component<tag>();
+        ecs::entity dead = reg.spawn_entity();
+
+        reg.commands().add_component(dead, tag{1});
+        reg.stage_component(dead, tag{1});
+        reg.kill_entity(dead);
+        ecs::entity reused = reg.spawn_entity();
+
+        reg.flush_commands();
+        reg.merge_staged();
+        CHECK(reused.index() == dead.index());
+        CHECK(!reg.has_component<tag>(reused));
+    }
+
+    void signatures()
+    {
+        ecs::registry reg;
+
+        reg.register_component<tag>();
+        reg.register_component<position>();
+        reg.register_component<hitbox>();
+        reg.register_component<sprite>();
+
+        ecs::entity a = reg.spawn_entity();
+        ecs::entity b = reg.spawn_entity();
+
+        reg.add_component(a, position{1});
+        reg.add_component(a, hitbox{1});
+        reg.add_component(a, sprite{1});
+        reg.add_component(b, position{2});
+        reg.add_component(b, hitbox{2});
+        reg.add_component(b, tag{2});
+        CHECK(reg.get_signature(a).count() == 3);
+        CHECK(reg.get_signature(a).test(ecs::component_id<hitbox>()) && !reg.get_signature(a).test(ecs::component_id<tag>()));
+        reg.remove_component<hitbox>(a);
+        CHECK(!reg.has_component<hitbox>(a) && reg.get_signature(a).count() == 2);
+        reg.add_component(a, hitbox{3});
+
+        // every storage of the components of a loses them, b keeps its own
+        reg.kill_entity(a);
+        CHECK(reg.get_signature(a).none());
+        CHECK(!reg.get_components<position>().contains(a.index()) && !reg.get_components<hitbox>().contains(a.index()));
+        CHECK(!reg.get_components<sprite>().contains<sprite>(a.index()));
+        CHECK(reg.get_components<position>().get(b.index()).x == 2 && reg.get_components<hitbox>().get(b.index()).w == 2);
+        CHECK(reg.get_components<hitbox>().live_count() == 1 && reg.get_signature(b).count() == 3);
+
+        ecs::entity reused = reg.spawn_entity();
+
+        CHECK(reused.index() == a.index() && reg.get_signature(reused).none());
+        CHECK(!reg.has_component<position>(reused) && !reg.has_component<sprite>(reused));
+    }
+
+    void batches()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> first = reg.spawn_entities(100);
+        bool contiguous = true;
+
+        for (std::size_t i = 0; i < first.size(); i++)
+            contiguous = contiguous && first[i].index() == i;
+        CHECK(first.size() == 100 && contiguous);
+
+        // the freed indexes are reused first, the others continue the range
+        reg.kill_entity(first[10]);
+        reg.kill_entity(first[20]);
+        std::vector<ecs::entity> second = reg.spawn_entities(4);
+
+        CHECK(second.size() == 4 && second[2].index() == 100 && second[3].index() == 101);
+        CHECK((second[0].index() == 10 || second[0].index() == 20) && second[0].index() != second[1].index());
+        CHECK(!reg.alive(first[10]) && reg.alive(second[0]) && reg.alive(second[1]));
+
+        auto &pointers = reg.register_component<std::unique_ptr<int>>();
+        std::vector<std::unique_ptr<int>> values;
+
+        for (std::size_t i = 0; i < second.size(); i++)
+            values.push_back(std::make_unique<int>(int(i)));
+        reg.add_components<std::unique_ptr<int>>(second, std::move(values));
+        CHECK(pointers.live_count() == 4 && *pointers.get(101) == 3);
+        CHECK(reg.has_component<std::unique_ptr<int>>(second[0]));
+
+        auto &positions = reg.register_component<position>();
+        std::vector<position> many(first.size(), position{5});
+        bool thrown = false;
+
+        try {
+            reg.add_components<position>(first, many);
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown && positions.live_count() == 0);
+
+        std::vector<ecs::entity> alive(first.begin(), first.begin() + 10);
+
+        many.resize(9);
+        thrown = false;
+        try {
+            reg.add_components<position>(alive, many);
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown && positions.live_count() == 0);
+        many.assign(10, position{5});
+        reg.add_components<position>(alive, many);
+        CHECK(positions.live_count() == 10 && positions.get(9).x == 5 && reg.has_component<position>(alive[9]));
+    }
+}
+
+int main()
+{
+    reused_index();
+    index_out_of_range();
+    dead_handle();
+    dead_handle_in_commands();
+    signatures();
+    batches();
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** entity_allocator test
+*/
+
+// Tests of the lock-free entity ids: threads allocating and releasing at the same time never get the same id, a double
+// release is ignored, and entities spawned by several threads get their staged components at the next merge.
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct owner { int thread; };
+
+    constexpr int thread_count = 4;
+
+    void allocate_and_release()
+    {
+        ecs::entity_allocator ids;
+        std::vector<std::vector<std::size_t>> kept(thread_count);
+        std::vector<std::thread> threads;
+
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&ids, &kept, t]() {
+                for (int i = 0; i < 2000; i++) {
+                    std::size_t id = ids.allocate();
+
+                    if (i % 2)
+                        ids.release(id);
+                    else
+                        kept[t].push_back(id);
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        std::vector<std::size_t> all;
+
+        for (auto const &list : kept)
+            all.insert(all.end(), list.begin(), list.end());
+        std::sort(all.begin(), all.end());
+        CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+        CHECK(std::none_of(all.begin(), all.end(), [&ids](std::size_t id) { return ids.is_free(id); }));
+        // every id given is either kept or waiting to be reused
+        CHECK(ids.issued() == all.size() + ids.free_count());
+    }
+
+    void double_release()
+    {
+        ecs::entity_allocator ids;
+        std::size_t first = ids.allocate();
+
+        ids.allocate();
+        ids.release(first);
+        ids.release(first);
+        CHECK(ids.free_count() == 1 && ids.generation(first) == 1);
+        CHECK(ids.allocate() == first && ids.allocate() == 2);
+    }
+
+    void spawn_from_threads()
+    {
+        ecs::registry reg;
+        std::vector<std::vector<ecs::entity>> spawned(thread_count);
+        std::vector<std::thread> threads;
+
+        reg.register_component<owner>();
+        for (int i = 0; i < 10; i++)
+            reg.kill_entity(reg.spawn_entity());
+        for (int t = 0; t < thread_count; t++) {
+            threads.emplace_back([&reg, &spawned, t]() {
+                for (int i = 0; i < 500; i++) {
+                    ecs::entity e = reg.spawn_entity();
+
+                    spawned[t].push_back(e);
+                    reg.stage_component(e, owner{t});
+                    if (i % 10 == 0)
+                        reg.stage_kill(e);
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        CHECK(!reg.has_component<owner>(spawned[0][1]));
+        reg.merge_staged();
+
+        std::vector<std::size_t> indexes;
+        auto &owners = reg.get_components<owner>();
+
+        for (int t = 0; t < thread_count; t++) {
+            for (std::size_t i = 0; i < spawned[t].size(); i++) {
+                ecs::entity e = spawned[t][i];
+
+                indexes.push_back(e.index());
+                CHECK(reg.alive(e) == (i % 10 != 0));
+                if (i % 10 != 0)
+                    CHECK(owners.get(e.index()).thread == t);
+            }
+        }
+        std::sort(indexes.begin(), indexes.end());
+        CHECK(std::adjacent_find(indexes.begin(), indexes.end()) == indexes.end());
+        CHECK(owners.live_count() == thread_count * 450);
+    }
+}
+
+int main()
+{
+    allocate_and_release();
+    double_release();
+    spawn_from_threads();
+    return check::failures() ? 1 : 0;
+}
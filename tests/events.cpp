@@ -0,0 +1,72 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** events test
+*/
+
+// Tests of the event channels: parameter deduction of trigger_event, events queued from other threads.
+
+#include <string>
+#include <thread>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    void trigger_string_literal()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+        std::string received;
+
+        reg.add_event<const char *>("msg", [&](ecs::registry &, std::vector<ecs::entity> &, const char *text) { received = text; });
+        reg.trigger_event("msg", entities, "hello");
+        CHECK(received == "hello");
+    }
+
+    void trigger_decayed_arguments()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+        int total = 0;
+        int const value = 3;
+        int &ref = total;
+
+        reg.add_event<int, int>("add", [&](ecs::registry &, std::vector<ecs::entity> &, int a, int b) { total += a + b; });
+        reg.trigger_event("add", entities, value, 4);
+        reg.trigger_event("add", entities, ref, 0);
+        CHECK(total == 14);
+    }
+
+    void push_while_flushing()
+    {
+        constexpr int count = 100000;
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+        ecs::event_channel<int> &channel = reg.get_event<int>("hit");
+        long long total = 0;
+
+        channel.subscribe([&](ecs::registry &, std::vector<ecs::entity> &, int value) { total += value; });
+        std::thread producer([&channel]() {
+            for (int i = 1; i <= count; i++)
+                channel.push(i);
+        });
+        while (total < static_cast<long long>(count) * (count + 1) / 2) {
+            channel.flush(reg, entities);
+            if (channel.pending() == 0)
+                std::this_thread::yield();
+        }
+        producer.join();
+        channel.flush(reg, entities);
+        CHECK(total == static_cast<long long>(count) * (count + 1) / 2);
+        CHECK(channel.pending() == 0);
+    }
+}
+
+int main()
+{
+    trigger_string_literal();
+    trigger_decayed_arguments();
+    push_while_flushing();
+    return check::failures() ? 1 : 0;
+}
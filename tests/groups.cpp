@@ -0,0 +1,60 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** groups test
+*/
+
+// Tests of the groups: the order and the constness of the components do not make a new group.
+
+#include "Check.hpp"
+#include "Registry.hpp"
+
+struct hitbox { int size; };
+struct velocity { int speed; };
+
+template <> struct ecs::component_storage<hitbox> { using type = ecs::packed_array<hitbox>; };
+template <> struct ecs::component_storage<velocity> { using type = ecs::packed_array<velocity>; };
+
+int main()
+{
+    ecs::registry reg;
+
+    reg.register_component<hitbox>();
+    reg.register_component<velocity>();
+    for (int i = 0; i < 10; i++) {
+        ecs::entity e = reg.spawn_entity();
+
+        reg.add_component(e, hitbox{i});
+        if (i % 2)
+            reg.add_component(e, velocity{i});
+    }
+
+    auto &owned = reg.get_owned_group<hitbox, velocity>();
+    auto &reversed = reg.get_owned_group<velocity, hitbox const>();
+    auto &viewed = reg.get_group<velocity, hitbox>();
+
+    CHECK(owned.size() == 5);
+    CHECK(&owned.entities() == &reversed.entities());
+    CHECK((&reg.get_owned_group<hitbox, velocity>() == &owned));
+    CHECK(!viewed.owned() && viewed.size() == 5);
+
+    ecs::entity added = reg.spawn_entity();
+
+    reg.add_component(added, velocity{3});
+    reg.add_component(added, hitbox{3});
+    CHECK(reversed.contains(added) && viewed.contains(added));
+
+    std::size_t matching = 0;
+    reversed.each([&matching](ecs::entity, velocity &v, hitbox const &h) {
+        matching += v.speed == h.size;
+    });
+    CHECK(matching == 6);
+
+    auto const &hitboxes = reg.get_components<hitbox>();
+    bool packed = true;
+    for (std::size_t i = 0; i < owned.size(); i++)
+        packed = packed && hitboxes.scan_index(i) == owned.entities()[i].index();
+    CHECK(packed);
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,38 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** module_health
+*/
+
+// Module loaded by the modules test: registers a component the program did not use yet and gives it to every entity with
+// a position, adds a system healing them and a handler of the "hit" event hurting them.
+
+#include <vector>
+#include "Module_components.hpp"
+#include "Registry.hpp"
+#include "Zipper.hpp"
+
+extern "C" {
+    void entrypoint(ecs::registry &reg)
+    {
+        auto &healths = reg.register_component<health>();
+
+        for (auto [id, pos] : ecs::zipper(reg.get_components<position>())) {
+            if (!healths.contains(id))
+                reg.add_component(reg.entity_from_index(id), health{static_cast<int>(pos.x)});
+        }
+        reg.add_system<health>([](ecs::registry &, std::vector<ecs::entity> &, auto &hps) {
+            for (auto [id, hp] : ecs::zipper(hps)) {
+                (void)id;
+                hp.value++;
+            }
+        });
+        reg.add_event<int>("hit", [](ecs::registry &r, std::vector<ecs::entity> &, int damage) {
+            for (auto [id, hp] : ecs::zipper(r.get_components<health>())) {
+                (void)id;
+                hp.value -= damage;
+            }
+        });
+    }
+}
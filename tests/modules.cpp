@@ -0,0 +1,79 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** modules test
+*/
+
+// Tests of the modules: a module registering a component gets the same component id as the program, reloading it
+// replaces its systems and event handlers but keeps its components, unloading it removes them.
+
+#include <vector>
+#include "Check.hpp"
+#include "Module_components.hpp"
+#include "Registry.hpp"
+
+namespace {
+    int health_of(ecs::registry &reg, ecs::entity e)
+    {
+        return reg.get_components<health>().get(e.index()).value;
+    }
+
+    // one run of the systems then one hit of 3, so -2 while the module is loaded once
+    void frame(ecs::registry &reg)
+    {
+        std::vector<ecs::entity> entities;
+
+        reg.run_systems(entities);
+        reg.trigger_event("hit", entities, 3);
+    }
+
+    void reload_and_unload(ecs::registry &reg, ecs::entity e)
+    {
+        frame(reg);
+        CHECK(health_of(reg, e) == 5);
+
+        // loading it again does nothing
+        reg.load_modules({TEST_MODULE, TEST_MODULE});
+        frame(reg);
+        CHECK(health_of(reg, e) == 3);
+
+        auto const *healths = &reg.get_components<health>();
+
+        CHECK(reg.reload_module(TEST_MODULE));
+        CHECK(&reg.get_components<health>() == healths && health_of(reg, e) == 3);
+        frame(reg);
+        CHECK(health_of(reg, e) == 1);
+
+        CHECK(reg.unload_module(TEST_MODULE));
+        frame(reg);
+        CHECK(reg.has_component<health>(e) && health_of(reg, e) == 1);
+        CHECK(!reg.unload_module(TEST_MODULE) && !reg.reload_module(TEST_MODULE));
+
+        // loaded again after unloading, its entrypoint runs again and registers a new container
+        reg.lib_entrypoint(TEST_MODULE);
+        CHECK(health_of(reg, e) == 7);
+        frame(reg);
+        CHECK(health_of(reg, e) == 5);
+    }
+}
+
+int main()
+{
+    ecs::registry reg;
+
+    reg.register_component<position>();
+    ecs::entity e = reg.spawn_entity();
+    reg.add_component(e, position{7, 0});
+    reg.lib_entrypoint(TEST_MODULE);
+    CHECK(reg.has_component<health>(e));
+    if (check::failures())
+        return 1;
+
+    auto &healths = reg.get_components<health>();
+
+    CHECK(healths.contains(e) && healths.get(e).value == 7);
+    CHECK(ecs::component_id<health>() != ecs::component_id<position>());
+    reload_and_unload(reg, e);
+    return check::failures() ? 1 : 0;
+}
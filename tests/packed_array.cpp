@@ -0,0 +1,137 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** packed_array test
+*/
+
+// Tests of the packed_array: the dense array stays packed and its index consistent through insertions, replacements and
+// erasures, and the registry stores the components selected with component_storage in it.
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct hitbox { int w; };
+    struct position { int x; };
+}
+
+template <> struct ecs::component_storage<hitbox> { using type = ecs::packed_array<hitbox>; };
+
+namespace {
+    // every live component is found from its entity and its entity from the component
+    bool consistent(ecs::packed_array<hitbox> const &boxes, std::vector<std::size_t> const &expected)
+    {
+        if (boxes.live_count() != expected.size() || boxes.entities().size() != expected.size())
+            return false;
+        for (std::size_t idx : expected) {
+            if (!boxes.contains(idx) || boxes.get(idx).w != static_cast<int>(idx) || boxes.get_index(boxes.get(idx)) != idx)
+                return false;
+        }
+        for (std::size_t pos = 0; pos < boxes.scan_size(); pos++) {
+            if (std::find(expected.begin(), expected.end(), boxes.scan_index(pos)) == expected.end())
+                return false;
+        }
+        return true;
+    }
+
+    void insert_and_erase()
+    {
+        ecs::packed_array<hitbox> boxes;
+        std::vector<std::size_t> expected;
+
+        for (std::size_t idx = 0; idx < 100; idx += 3) {
+            boxes.insert_at(idx, hitbox{int(idx)});
+            expected.push_back(idx);
+        }
+        CHECK(consistent(boxes, expected));
+        CHECK(boxes.size() == 100);
+
+        // the last component moves into the hole, the others keep their place
+        std::size_t last = boxes.entities().back();
+
+        boxes.erase(0);
+        expected.erase(expected.begin());
+        CHECK(boxes.entities().front() == last);
+        CHECK(consistent(boxes, expected));
+
+        boxes.erase(last);
+        boxes.erase(1);
+        boxes.erase(1000);
+        expected.erase(std::find(expected.begin(), expected.end(), last));
+        CHECK(consistent(boxes, expected));
+
+        boxes.insert_at(30, hitbox{30});
+        CHECK(boxes.live_count() == expected.size());
+        CHECK(consistent(boxes, expected));
+
+        std::size_t sum = 0;
+        std::size_t expected_sum = 0;
+
+        for (auto const &box : std::as_const(boxes))
+            sum += box.w;
+        for (std::size_t idx : expected)
+            expected_sum += idx;
+        CHECK(sum == expected_sum);
+    }
+
+    void access()
+    {
+        ecs::packed_array<hitbox> boxes;
+        ecs::packed_array<hitbox> const &const_boxes = boxes;
+
+        boxes.insert_at(4, hitbox{4});
+        CHECK(boxes[4].has_value() && boxes[4]->w == 4);
+        CHECK(!boxes[2] && !const_boxes[2]);
+        CHECK(boxes.get_index(hitbox{4}) == ecs::packed_array<hitbox>::npos);
+
+        bool thrown = false;
+
+        try {
+            boxes[5];
+        } catch (std::out_of_range const &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+        boxes.clear();
+        CHECK(boxes.live_count() == 0 && !boxes.contains(4));
+    }
+
+    void registry_storage()
+    {
+        ecs::registry reg;
+        auto &boxes = reg.register_component<hitbox>();
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        for (int i = 0; i < 10; i++) {
+            entities.push_back(reg.spawn_entity());
+            reg.add_component(entities.back(), hitbox{i});
+            reg.add_component(entities.back(), position{i});
+        }
+        reg.kill_entity(entities[2]);
+        reg.remove_component<hitbox>(entities[5]);
+
+        int count = 0;
+
+        for (auto [idx, box, pos] : ecs::zipper(boxes, reg.get_components<position>())) {
+            CHECK(box.w == pos.x && static_cast<std::size_t>(box.w) == idx);
+            count++;
+        }
+        CHECK(count == 8);
+        CHECK(boxes.live_count() == 8 && boxes.scan_size() == 8);
+    }
+}
+
+int main()
+{
+    insert_and_erase();
+    access();
+    registry_storage();
+    return check::failures() ? 1 : 0;
+}
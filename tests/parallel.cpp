@@ -0,0 +1,103 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** parallel test
+*/
+
+// Tests of par_for_each: the components written by a function that only writes its own entity are the same with one
+// thread and with several, below and above the threshold and around the blocks of 64 positions.
+
+#include <cstdint>
+#include <vector>
+#include "Check.hpp"
+#include "Packed_array.hpp"
+#include "Parallel.hpp"
+#include "Sparse_array.hpp"
+
+namespace {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+
+    // Deterministic choice of the entities having a component, independent for each component
+    bool present(std::size_t idx, std::size_t salt)
+    {
+        std::uint64_t h = (idx + 1) * 0x9E3779B97F4A7C15ull ^ (salt + 1) * 0xC2B2AE3D27D4EB4Full;
+
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ull;
+        return h % 4 != 0;
+    }
+
+    struct pools {
+        ecs::sparse_array<position> positions;
+        ecs::packed_array<velocity> velocities;
+        std::vector<int> visits;
+    };
+
+    void fill(pools &p, std::size_t count)
+    {
+        p.visits.assign(count, 0);
+        for (std::size_t i = 0; i < count; i++) {
+            if (present(i, 0))
+                p.positions.insert_at(i, position{float(i), float(i % 7)});
+            if (present(i, 1))
+                p.velocities.insert_at(i, velocity{float(i % 13) * 0.5f, float(i % 5) - 2.0f});
+        }
+    }
+
+    void run(pools &p, std::size_t threshold, ecs::thread_pool &pool)
+    {
+        ecs::par_for_each(ecs::zipper(p.positions, p.velocities), [&p](std::size_t id, position &pos, velocity const &vel) {
+            pos.x += vel.x * float(id % 17);
+            pos.y = pos.y * 0.5f + vel.y;
+            p.visits[id]++;
+        }, threshold, pool);
+    }
+
+    bool same(pools const &a, pools const &b, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; i++) {
+            if (a.visits[i] != b.visits[i] || a.positions.contains(i) != b.positions.contains(i))
+                return false;
+            if (a.positions.contains(i) && (a.positions.get(i).x != b.positions.get(i).x || a.positions.get(i).y != b.positions.get(i).y))
+                return false;
+        }
+        return true;
+    }
+
+    void compare(std::size_t count, std::size_t threshold, ecs::thread_pool &serial, ecs::thread_pool &parallel)
+    {
+        pools expected;
+        pools result;
+        bool visited_once = true;
+
+        fill(expected, count);
+        fill(result, count);
+        for (int pass = 0; pass < 3; pass++) {
+            run(expected, threshold, serial);
+            run(result, threshold, parallel);
+        }
+        for (std::size_t i = 0; i < count; i++)
+            visited_once = visited_once && expected.visits[i] == (expected.positions.contains(i) && expected.velocities.contains(i) ? 3 : 0);
+        CHECK(visited_once);
+        if (!same(expected, result, count))
+            std::fprintf(stderr, "different results with %zu entities and a threshold of %zu\n", count, threshold);
+        CHECK(same(expected, result, count));
+    }
+}
+
+int main()
+{
+    ecs::thread_pool serial(1);
+    ecs::thread_pool parallel(4);
+
+    // Below and above the default threshold
+    for (std::size_t count : {100, 4095, 4096, 4097, 20000, 100000})
+        compare(count, ecs::par_for_each_threshold, serial, parallel);
+    // Small thresholds split the iteration in chunks of a few blocks of 64 positions
+    for (std::size_t count : {63, 64, 65, 127, 128, 129, 64 * 9 - 1, 64 * 9, 64 * 9 + 1, 5000})
+        for (std::size_t threshold : {1, 64, 65, 128})
+            compare(count, threshold, serial, parallel);
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,125 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** prefabs test
+*/
+
+// Tests of the prefabs: named components deserialized once when compiled, copied on every instantiated entity with its
+// signature and its groups, dead entities rejected before anything is stamped.
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { int x, y; };
+    struct health { int points; };
+    struct name { std::string value; };
+
+    // stands for a parsed level file
+    struct record { int a; int b; };
+
+    int deserialized = 0;
+}
+
+template <> struct ecs::component_storage<health> { using type = ecs::packed_array<health>; };
+
+namespace {
+    void register_components(ecs::registry &reg)
+    {
+        reg.register_component<position, record>("position", [](record &r) {
+            deserialized++;
+            return position{r.a, r.b};
+        });
+        reg.register_component<health, record>("health", [](record &r) {
+            deserialized++;
+            return health{r.a};
+        });
+        reg.register_component<name>();
+    }
+
+    void compiled_once()
+    {
+        ecs::registry reg;
+        ecs::registry::prefab enemy;
+        record pos{1, 2};
+        record hp{100, 0};
+
+        register_components(reg);
+        deserialized = 0;
+        reg.add_component("position", enemy, pos);
+        reg.add_component("health", enemy, hp);
+        enemy.add(name{"enemy"});
+        CHECK(deserialized == 2);
+        CHECK(enemy.has<position>() && enemy.has<health>() && enemy.has<name>() && enemy.get_signature().count() == 3);
+
+        std::vector<ecs::entity> wave = reg.instantiate(enemy, 50);
+        ecs::entity boss = reg.instantiate(enemy);
+
+        wave.push_back(boss);
+        CHECK(deserialized == 2);
+        for (ecs::entity e : wave) {
+            CHECK(reg.get_signature(e) == enemy.get_signature());
+            CHECK(reg.get_components<position>().get(e.index()).y == 2);
+            CHECK(reg.get_components<health>().get(e.index()).points == 100);
+            CHECK(reg.get_components<name>().get(e.index()).value == "enemy");
+        }
+        CHECK(reg.get_components<health>().live_count() == 51);
+    }
+
+    void copies_and_existing_entities()
+    {
+        ecs::registry reg;
+        ecs::registry::prefab base;
+
+        register_components(reg);
+        base.add(position{1, 1}).add(name{"base"});
+
+        ecs::registry::prefab copy = base;
+
+        // replacing a component of the original does not change the copy
+        base.add(position{9, 9});
+        CHECK(copy.get_signature() == base.get_signature());
+
+        ecs::entity e = reg.spawn_entity();
+
+        reg.add_component(e, health{7});
+        reg.instantiate(copy, std::vector<ecs::entity>{e});
+        CHECK(reg.get_components<position>().get(e.index()).x == 1 && reg.get_components<health>().get(e.index()).points == 7);
+        CHECK(reg.get_signature(e).count() == 3);
+
+        auto &group = reg.get_group<health, position>();
+
+        CHECK(group.size() == 1);
+        reg.instantiate(base, std::vector<ecs::entity>{e});
+        CHECK(reg.get_components<position>().get(e.index()).x == 9);
+
+        ecs::registry::prefab armored;
+
+        armored.add(health{50}).add(position{0, 0});
+        reg.instantiate(armored, 3);
+        CHECK(group.size() == 4);
+
+        ecs::entity dead = reg.spawn_entity();
+        ecs::entity other = reg.spawn_entity();
+        bool thrown = false;
+
+        reg.kill_entity(dead);
+        try {
+            reg.instantiate(base, std::vector<ecs::entity>{other, dead});
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown && !reg.has_component<position>(other) && reg.get_signature(other).none());
+    }
+}
+
+int main()
+{
+    compiled_once();
+    copies_and_existing_entities();
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,132 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** profiler test
+*/
+
+// Tests of the profiler, built with ECS_PROFILING: calls of the event handlers, entities iterated by the systems, JSON
+// escaping of the names, frames closed when the calls are recorded without run_systems.
+
+#include <sstream>
+#include "Check.hpp"
+#include "Parallel.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { float x; };
+    struct velocity { float x; };
+
+    ecs::profiler::zone_stats const *find_zone(std::vector<ecs::profiler::zone_stats> const &zones, std::string const &name)
+    {
+        for (auto const &zone : zones) {
+            if (zone.name == name)
+                return &zone;
+        }
+        return nullptr;
+    }
+
+    void event_calls()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+        auto &hit = reg.get_event<int>("hit");
+        int sum = 0;
+        int batches = 0;
+
+        hit.subscribe([&sum](ecs::registry &, std::vector<ecs::entity> &, int damage) { sum += damage; });
+        hit.subscribe_batch([&batches](ecs::registry &, std::vector<ecs::entity> &, std::vector<std::tuple<int>> const &) { batches++; });
+        for (int i = 1; i <= 5; i++)
+            hit.push(i);
+        reg.flush_events(entities);
+        hit.trigger(reg, entities, 10);
+
+        auto zones = reg.get_profiler().stats();
+        auto handler = find_zone(zones, "hit #0");
+        auto batch = find_zone(zones, "hit batch #0");
+
+        CHECK(sum == 25);
+        CHECK(batches == 2);
+        CHECK(handler && handler->calls == 6);
+        CHECK(batch && batch->calls == 2);
+    }
+
+    void system_entities()
+    {
+        ecs::registry reg;
+        std::vector<ecs::entity> entities;
+        ecs::thread_pool pool(4);
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        for (std::size_t i = 0; i < 20000; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{0});
+            if (i % 4 == 0)
+                reg.add_component(e, velocity{1});
+        }
+        // only the entities with both components are counted, not the smallest pool
+        reg.add_system<position, velocity const>("movement", [](ecs::registry &, std::vector<ecs::entity> &,
+            ecs::sparse_array<position> &positions, ecs::sparse_array<velocity> const &velocities) {
+            for (auto [id, pos, vel] : ecs::zipper(positions, velocities)) {
+                if (id % 8 == 0)
+                    pos.x += vel.x;
+            }
+        });
+        reg.add_system<position>("parallel", [&pool](ecs::registry &, std::vector<ecs::entity> &, ecs::sparse_array<position> &positions) {
+            ecs::par_for_each(ecs::zipper(positions), [](std::size_t, position &pos) { pos.x += 1; }, 64, pool);
+        });
+        reg.run_systems(entities);
+        reg.run_systems(entities);
+
+        auto zones = reg.get_profiler().stats();
+        auto movement = find_zone(zones, "movement");
+        auto parallel = find_zone(zones, "parallel");
+
+        CHECK(movement && movement->calls == 2 && movement->entities == 2 * 5000);
+        CHECK(parallel && parallel->calls == 2 && parallel->entities == 2 * 20000);
+    }
+
+    void escaped_names()
+    {
+        CHECK(ecs::detail::json_escape("a\"b\\c") == "a\\\"b\\\\c");
+        CHECK(ecs::detail::json_escape("line\nnext") == "line\\u000anext");
+
+        ecs::profiler prof;
+        std::ostringstream out;
+
+        prof.record(prof.add_zone("say \"hi\"", "system"), ecs::profiler::clock::now(), 0);
+        prof.end_frame();
+        prof.write_chrome_trace(out);
+        CHECK(out.str().find("\"name\":\"say \\\"hi\\\"\"") != std::string::npos);
+    }
+
+    void calls_without_frames()
+    {
+        ecs::profiler prof(2);
+        std::size_t zone = prof.add_zone("hit", "event");
+        std::ostringstream out;
+
+        for (std::size_t i = 0; i < 5 * ecs::profiler::max_frame_events; i++)
+            prof.record(zone, ecs::profiler::clock::now(), 1);
+        prof.write_chrome_trace(out);
+
+        std::string trace = out.str();
+        std::size_t events = 0;
+
+        for (std::size_t pos = trace.find("\"ph\""); pos != std::string::npos; pos = trace.find("\"ph\"", pos + 1))
+            events++;
+        CHECK(prof.stats()[zone].calls == 5 * ecs::profiler::max_frame_events);
+        CHECK(events == 2 * ecs::profiler::max_frame_events);
+    }
+}
+
+int main()
+{
+    event_calls();
+    system_entities();
+    escaped_names();
+    calls_without_frames();
+    return check::failures() ? 1 : 0;
+}
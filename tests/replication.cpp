@@ -0,0 +1,138 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** replication test
+*/
+
+// Tests of the change tracking: changes seen through every mutable access, deltas replicating additions, modifications
+// and removals, including when the change log overflowed and the containers are scanned.
+
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { int x, y; };
+    struct health { int hp; };
+}
+
+template <> struct ecs::track_changes<position> : std::true_type {};
+template <> struct ecs::track_changes<health> : std::true_type {};
+template <> struct ecs::component_storage<health> { using type = ecs::packed_array<health>; };
+
+namespace {
+    void next_frame(ecs::registry &reg)
+    {
+        std::vector<ecs::entity> none;
+
+        reg.run_systems(none);
+    }
+
+    template <class Component, class Same> bool mirrored(ecs::registry &from, ecs::registry &to, Same &&same)
+    {
+        auto const &sent = std::as_const(from).get_components<Component>();
+        auto const &received = std::as_const(to).get_components<Component>();
+        std::size_t size = std::max(sent.size(), received.size());
+
+        for (std::size_t i = 0; i < size; i++) {
+            if (sent.contains(i) != received.contains(i))
+                return false;
+            if (sent.contains(i) && !same(sent.get(i), received.get(i)))
+                return false;
+        }
+        return sent.live_count() == received.live_count();
+    }
+
+    bool mirrored(ecs::registry &from, ecs::registry &to)
+    {
+        return mirrored<position>(from, to, [](position const &a, position const &b) { return a.x == b.x && a.y == b.y; })
+            && mirrored<health>(from, to, [](health const &a, health const &b) { return a.hp == b.hp; });
+    }
+
+    void packed_iteration_changes()
+    {
+        ecs::packed_array<health> pool;
+
+        for (std::size_t i = 0; i < 4; i++)
+            pool.insert_at(i * 2, health{1});
+        pool.set_tick(2);
+        CHECK(pool.changes(1).empty());
+        for (auto &h : pool)
+            h.hp++;
+        CHECK(pool.changes(1) == (std::vector<std::size_t>{0, 2, 4, 6}));
+        pool.set_tick(3);
+        pool.data()[1].hp = 5;
+        CHECK(pool.changes(2).size() == 4);
+        pool.set_tick(4);
+        std::as_const(pool).data();
+        CHECK(pool.changes(3).empty());
+    }
+
+    void delta_round_trip()
+    {
+        ecs::registry server;
+        ecs::registry client;
+        std::vector<std::byte> buffer;
+        std::vector<ecs::entity> entities;
+        ecs::tick_t acked = 0;
+
+        for (ecs::registry *reg : {&server, &client}) {
+            reg->register_component<position>();
+            reg->register_component<health>();
+        }
+        for (int i = 0; i < 1000; i++) {
+            ecs::entity e = server.spawn_entity();
+
+            server.add_component(e, position{i, 0});
+            if (i % 3 == 0)
+                server.add_component(e, health{100});
+            entities.push_back(e);
+        }
+        server.encode_delta(buffer, acked);
+        acked = client.apply_delta(buffer);
+        CHECK(mirrored(server, client));
+
+        // modifications through get, operator[] and iteration, removals and additions
+        next_frame(server);
+        server.get_components<position>().get(entities[10]).x = -1;
+        server.get_components<position>()[entities[20]]->y = 7;
+        for (auto &h : server.get_components<health>())
+            h.hp -= 10;
+        server.remove_component<position>(entities[30]);
+        server.kill_entity(entities[40]);
+        server.add_component(entities[50], health{1});
+        server.add_component(server.spawn_entity(), position{5000, 5000});
+        server.encode_delta(buffer, acked);
+        acked = client.apply_delta(buffer);
+        CHECK(mirrored(server, client));
+
+        // nothing changed: the delta is empty
+        next_frame(server);
+        server.encode_delta(buffer, acked);
+        std::size_t empty_size = buffer.size();
+        acked = client.apply_delta(buffer);
+        CHECK(mirrored(server, client));
+
+        // more changes in a tick than the room of the log: the containers are scanned instead
+        next_frame(server);
+        for (int i = 0; i < 200; i++)
+            server.add_component(server.spawn_entity(), position{-i, -i});
+        auto &positions = server.get_components<position>();
+        for (ecs::entity e : entities) {
+            if (positions.contains(e))
+                positions.get(e).y++;
+        }
+        server.encode_delta(buffer, acked);
+        CHECK(buffer.size() > empty_size);
+        acked = client.apply_delta(buffer);
+        CHECK(mirrored(server, client));
+        CHECK(acked == server.tick());
+    }
+}
+
+int main()
+{
+    packed_iteration_changes();
+    delta_round_trip();
+    return check::failures() ? 1 : 0;
+}
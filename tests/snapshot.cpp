@@ -0,0 +1,188 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** snapshot test
+*/
+
+// Tests of registry::snapshot and restore: components restored, pools registered after the snapshot emptied,
+// fixed binary format independent of the build.
+
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+    struct sprite { int id; };
+    // same data as position with a larger slot, so its sparse_array has smaller pages, read with a serializer
+    struct wide_position { float x, y; std::string label; };
+    struct health { int points; };
+    struct speed { float value; };
+    // declared in the other order, so they get their ids after health and speed, in the other order
+    struct client_speed { float value; };
+    struct client_health { int points; };
+}
+
+template <> struct ecs::component_storage<velocity> { using type = ecs::packed_array<velocity>; };
+template <> struct ecs::component_storage<health> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<speed> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<client_speed> { using type = ecs::archetype_storage; };
+template <> struct ecs::component_storage<client_health> { using type = ecs::archetype_storage; };
+template <> struct ecs::serializer<wide_position> {
+    static void write(ecs::binary_writer &writer, wide_position const &pos) { writer.write(pos.x); writer.write(pos.y); }
+    static wide_position read(ecs::binary_reader &reader)
+    {
+        wide_position pos{};
+
+        pos.x = reader.read<float>();
+        pos.y = reader.read<float>();
+        return pos;
+    }
+};
+
+namespace {
+    void fixed_integers()
+    {
+        std::vector<std::byte> buffer;
+        ecs::binary_writer writer(buffer);
+        std::size_t indexes[] = {1, 0x0102030405};
+        std::bitset<12> bits;
+
+        bits.set(0).set(9);
+        writer.write_uint<std::uint32_t>(0x01020304);
+        writer.write_uints<std::uint64_t>(indexes, 2);
+        writer.write_bits(bits);
+        CHECK(buffer.size() == 4 + 16 + 4 + 2);
+        CHECK(buffer[0] == std::byte{4} && buffer[3] == std::byte{1});
+        CHECK(buffer[4] == std::byte{1} && buffer[12] == std::byte{5} && buffer[16] == std::byte{1});
+        CHECK(buffer[24] == std::byte{1} && buffer[25] == std::byte{2});
+
+        ecs::binary_reader reader(buffer);
+        std::size_t read_indexes[2];
+
+        CHECK(reader.read_uint<std::uint32_t>() == 0x01020304);
+        reader.read_uints<std::uint64_t>(read_indexes, 2);
+        CHECK(read_indexes[0] == 1 && read_indexes[1] == 0x0102030405);
+        CHECK(reader.read_bits<16>() == std::bitset<16>(bits.to_ulong()));
+        CHECK(reader.done());
+
+        ecs::binary_reader narrow(buffer.data() + 20, 6);
+        bool thrown = false;
+
+        try {
+            narrow.read_bits<8>();
+        } catch (std::runtime_error const &) {
+            thrown = true;
+        }
+        CHECK(thrown);
+    }
+
+    void pages_of_another_size()
+    {
+        ecs::sparse_array<position> from;
+        ecs::sparse_array<wide_position> to;
+        std::vector<std::byte> buffer;
+        ecs::binary_writer writer(buffer);
+
+        CHECK(ecs::sparse_array<position>::page_size != ecs::sparse_array<wide_position>::page_size);
+        for (std::size_t idx : {0, 7, 300, 5000, 100000})
+            from.insert_at(idx, position{static_cast<float>(idx), 1});
+        // a run of used slots crossing the pages of both arrays
+        for (std::size_t idx = 1000; idx < 3000; idx++)
+            from.insert_at(idx, position{static_cast<float>(idx), 2});
+        from.snapshot(writer);
+
+        ecs::binary_reader reader(buffer);
+
+        to.restore(reader);
+        CHECK(reader.done());
+        CHECK(to.live_count() == 2005 && to.size() == from.size());
+        for (std::size_t idx : {0, 7, 300, 5000, 100000})
+            CHECK(to.contains(idx) && to.get(idx).x == static_cast<float>(idx));
+        for (std::size_t idx = 1000; idx < 3000; idx++)
+            CHECK(to.contains(idx) && to.get(idx).x == static_cast<float>(idx) && to.get(idx).y == 2);
+        CHECK(!to.contains(1) && !to.contains(999) && !to.contains(3000) && !to.contains(99999));
+
+        ecs::sparse_array<position> back;
+        std::vector<std::byte> again;
+        ecs::binary_writer rewriter(again);
+        ecs::binary_reader rereader(buffer);
+
+        back.restore(rereader);
+        back.snapshot(rewriter);
+        CHECK(again == buffer);
+    }
+
+    void pools_keyed_by_name()
+    {
+        ecs::registry server;
+        ecs::registry client;
+
+        server.register_component<position>("position");
+        server.register_component<sprite>();
+        client.register_component<wide_position>("position");
+        client.register_component<sprite>();
+
+        ecs::entity e = server.spawn_entity();
+
+        server.add_component(e, position{4, 2});
+        server.add_component(e, sprite{3});
+        server.spawn_entity();
+        client.restore(server.snapshot());
+        CHECK(client.has_component<wide_position>(e) && client.get_components<wide_position>().get(e.index()).y == 2);
+        CHECK(client.has_component<sprite>(e) && client.get_components<sprite>().get(e.index()).id == 3);
+        CHECK(client.stats().alive == 2);
+    }
+
+    void archetypes_keyed_by_name()
+    {
+        ecs::registry server;
+        ecs::registry client;
+
+        server.register_component<health>("health");
+        server.register_component<speed>("speed");
+        client.register_component<client_speed>("speed");
+        client.register_component<client_health>("health");
+
+        ecs::entity e = server.spawn_entity();
+
+        server.add_component(e, health{10});
+        server.add_component(e, speed{2.5f});
+        CHECK(ecs::component_id<health>() < ecs::component_id<speed>());
+        CHECK(ecs::component_id<client_speed>() < ecs::component_id<client_health>());
+        client.restore(server.snapshot());
+        CHECK(client.has_component<client_health>(e) && client.has_component<client_speed>(e));
+        CHECK(client.get_components<client_health>().get<client_health>(e.index()).points == 10);
+        CHECK(client.get_components<client_speed>().get<client_speed>(e.index()).value == 2.5f);
+    }
+}
+
+int main()
+{
+    ecs::registry reg;
+
+    reg.register_component<position>();
+    ecs::entity e = reg.spawn_entity();
+    reg.add_component(e, position{1, 2});
+
+    std::vector<std::byte> buffer = reg.snapshot();
+
+    reg.register_component<velocity>();
+    reg.register_component<sprite>();
+    reg.add_component(e, position{5, 5});
+    reg.add_component(e, velocity{3, 4});
+    reg.add_component(e, sprite{7});
+    reg.restore(buffer);
+
+    CHECK(reg.has_component<position>(e) && reg.get_components<position>().get(e).x == 1);
+    CHECK(!reg.has_component<velocity>(e) && reg.get_components<velocity>().live_count() == 0);
+    CHECK(!reg.has_component<sprite>(e) && reg.get_components<sprite>().live_count() == 0);
+    reg.add_component(e, velocity{1, 1});
+    CHECK(reg.get_components<velocity>().contains(e));
+    fixed_integers();
+    pages_of_another_size();
+    pools_keyed_by_name();
+    archetypes_keyed_by_name();
+    return check::failures() ? 1 : 0;
+}
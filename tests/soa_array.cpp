@@ -0,0 +1,112 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** soa_array test
+*/
+
+// Tests of the soa_array: fields stored in aligned columns following the entities through insertions and erasures,
+// pack_with putting the shared entities first in the same order, and the zipper references.
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct position { float x, y; };
+    struct velocity { float x, y; };
+}
+
+template <> struct ecs::soa_fields<position> { static constexpr auto fields = std::make_tuple(&position::x, &position::y); };
+template <> struct ecs::soa_fields<velocity> { static constexpr auto fields = std::make_tuple(&velocity::x, &velocity::y); };
+template <> struct ecs::component_storage<position> { using type = ecs::soa_array<position>; };
+template <> struct ecs::component_storage<velocity> { using type = ecs::soa_array<velocity>; };
+
+namespace {
+    void columns()
+    {
+        ecs::soa_array<position> positions;
+
+        for (std::size_t i = 0; i < 100; i++)
+            positions.insert_at(i * 2, position{float(i), -float(i)});
+        positions.erase(0);
+        positions.erase(50);
+        positions.erase(51);
+        positions.insert_at(10, position{7, 7});
+
+        auto xs = positions.field<&position::x>();
+        auto ys = std::as_const(positions).field<&position::y>();
+
+        CHECK(reinterpret_cast<std::uintptr_t>(xs.data()) % 64 == 0 && reinterpret_cast<std::uintptr_t>(ys.data()) % 64 == 0);
+        CHECK(xs.size() == 98 && positions.live_count() == 98);
+        CHECK(!positions.contains(0) && !positions.contains(50) && positions.contains(52));
+        for (std::size_t pos = 0; pos < positions.scan_size(); pos++) {
+            std::size_t entity = positions.scan_index(pos);
+            float expected = entity == 10 ? 7.f : float(entity / 2);
+
+            CHECK(xs[pos] == expected && ys[pos] == (entity == 10 ? 7.f : -expected));
+        }
+
+        position loaded = positions[4].load();
+
+        CHECK(loaded.x == 2 && loaded.y == -2);
+        positions[4].store(position{1, 1});
+        CHECK(positions.get(4).get<&position::y>() == 1);
+        CHECK(!positions[3].has_value());
+    }
+
+    void packed_together()
+    {
+        ecs::soa_array<position> positions;
+        ecs::soa_array<velocity> velocities;
+
+        for (std::size_t i = 0; i < 50; i++)
+            positions.insert_at(i, position{float(i), 0});
+        for (std::size_t i = 0; i < 50; i += 5)
+            velocities.insert_at(49 - i, velocity{float(49 - i), 1});
+
+        std::size_t count = positions.pack_with(velocities);
+        auto px = positions.field<&position::x>();
+        auto vx = velocities.field<&velocity::x>();
+
+        CHECK(count == 10);
+        for (std::size_t i = 0; i < count; i++) {
+            CHECK(positions.entities()[i] == velocities.entities()[i]);
+            CHECK(px[i] == vx[i]);
+        }
+        for (std::size_t i = count; i < positions.live_count(); i++)
+            CHECK(!velocities.contains(positions.entities()[i]));
+    }
+
+    void registry_zipper()
+    {
+        ecs::registry reg;
+        auto &positions = reg.register_component<position>();
+
+        reg.register_component<velocity>();
+        for (int i = 0; i < 20; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, position{0, 0});
+            if (i % 4 == 0)
+                reg.add_component(e, velocity{float(i), 2});
+        }
+        for (auto [id, pos, vel] : ecs::zipper(positions, reg.get_components<velocity>())) {
+            (void)id;
+            pos.store(position{pos.get<&position::x>() + vel.get<&velocity::x>(), vel.load().y});
+        }
+        for (std::size_t idx = 0; idx < 20; idx++)
+            CHECK(positions[idx].load().x == (idx % 4 == 0 ? float(idx) : 0.f));
+    }
+}
+
+int main()
+{
+    columns();
+    packed_together();
+    registry_zipper();
+    return check::failures() ? 1 : 0;
+}
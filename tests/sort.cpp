@@ -0,0 +1,110 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** sort test
+*/
+
+// Tests of the sorting of the packed pools: both algorithms keep the index consistent, the entities of an owning group
+// stay first with its other pools following, and the non-owning groups are ordered like the pool.
+
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct depth { int z; };
+    struct sprite { int id; };
+    struct layer { int l; };
+}
+
+template <> struct ecs::component_storage<depth> { using type = ecs::packed_array<depth>; };
+template <> struct ecs::component_storage<sprite> { using type = ecs::packed_array<sprite>; };
+
+namespace {
+    bool by_z(depth const &a, depth const &b)
+    {
+        return a.z < b.z;
+    }
+
+    bool sorted(ecs::packed_array<depth> const &depths, std::size_t first, std::size_t last)
+    {
+        for (std::size_t pos = first; pos + 1 < last; pos++) {
+            if (depths.get(depths.scan_index(pos + 1)).z < depths.get(depths.scan_index(pos)).z)
+                return false;
+        }
+        return true;
+    }
+
+    // the z of an entity is a function of its index, so a component found from its entity proves the index follows
+    int z_of(std::size_t idx, int frame)
+    {
+        return static_cast<int>((idx * 37) % 101) + frame * static_cast<int>(idx % 3);
+    }
+
+    void pool_ranges()
+    {
+        ecs::packed_array<depth> depths;
+
+        for (std::size_t idx = 0; idx < 60; idx++)
+            depths.insert_at(idx, depth{z_of(idx, 0)});
+        depths.sort(by_z, 10, 40);
+        CHECK(sorted(depths, 10, 40) && !sorted(depths, 0, 60));
+        depths.insertion_sort(by_z);
+        CHECK(sorted(depths, 0, 60));
+        for (std::size_t idx = 0; idx < 60; idx++)
+            CHECK(depths.get(idx).z == z_of(idx, 0));
+    }
+
+    void groups_follow(ecs::registry::sort_mode mode)
+    {
+        ecs::registry reg;
+        auto &depths = reg.register_component<depth>();
+        auto &sprites = reg.register_component<sprite>();
+
+        reg.register_component<layer>();
+        for (std::size_t i = 0; i < 100; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, depth{z_of(e.index(), 0)});
+            if (i % 2)
+                reg.add_component(e, sprite{static_cast<int>(e.index())});
+            if (i % 3)
+                reg.add_component(e, layer{1});
+        }
+
+        auto &owned = reg.get_owned_group<depth, sprite>();
+        auto &viewed = reg.get_group<depth, layer const>();
+
+        // the first sort is full, the insertion mode then keeps the order of frames changing the z a little
+        for (int frame = 0; frame < 3; frame++) {
+            for (std::size_t pos = 0; pos < depths.live_count(); pos++)
+                depths.get(depths.scan_index(pos)).z = z_of(depths.scan_index(pos), frame);
+            reg.sort<depth>(by_z, frame ? mode : ecs::registry::sort_mode::full);
+
+            CHECK(owned.size() == 50 && sorted(depths, 0, 50) && sorted(depths, 50, 100));
+            for (std::size_t i = 0; i < owned.size(); i++) {
+                std::size_t idx = owned.entities()[i].index();
+
+                CHECK(depths.scan_index(i) == idx && sprites.scan_index(i) == idx);
+                CHECK(sprites.get(idx).id == static_cast<int>(idx));
+            }
+            for (std::size_t idx = 0; idx < 100; idx++)
+                CHECK(depths.get(idx).z == z_of(idx, frame));
+
+            bool ordered = viewed.size() == 66;
+
+            for (std::size_t i = 0; i + 1 < viewed.size(); i++)
+                ordered = ordered && !by_z(depths.get(viewed.entities()[i + 1].index()), depths.get(viewed.entities()[i].index()));
+            CHECK(ordered);
+        }
+    }
+}
+
+int main()
+{
+    pool_ranges();
+    groups_follow(ecs::registry::sort_mode::full);
+    groups_follow(ecs::registry::sort_mode::insertion);
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** sparse_array test
+*/
+
+// Tests of the sparse_array: live count kept through the mutable slots, pages that are not allocated, reads that do not
+// allocate them, get_index finding the entity of a component from its address.
+
+#include <memory>
+#include <optional>
+#include <utility>
+#include "Check.hpp"
+#include "Sparse_array.hpp"
+
+namespace {
+    struct value { int v; };
+    struct tracked { int v; };
+}
+
+template <> struct ecs::track_changes<tracked> : std::true_type {};
+
+namespace {
+
+    void assign_through_operator()
+    {
+        ecs::sparse_array<value> arr;
+
+        arr.insert_at(10, value{1});
+        arr[5] = value{2};
+        CHECK(arr.live_count() == 2);
+        arr.erase(5);
+        CHECK(arr.live_count() == 1);
+        arr.erase(10);
+        CHECK(arr.live_count() == 0);
+        arr[3] = value{3};
+        arr[3].reset();
+        arr[4] = value{4};
+        CHECK(arr.live_count() == 1);
+        arr.set_tick(2);
+        CHECK(arr.live_count() == 1);
+        arr.erase(4);
+        CHECK(arr.live_count() == 0);
+    }
+
+    void iterate_unallocated_pages()
+    {
+        ecs::sparse_array<value> arr;
+        std::size_t far = ecs::sparse_array<value>::page_size * 3 + 7;
+
+        arr.insert_at(far, value{1});
+        CHECK(arr.allocated_pages() == 1);
+
+        ecs::sparse_array<value> const &view = arr;
+        std::size_t present = 0;
+
+        for (auto const &slot : view)
+            present += slot.has_value();
+        CHECK(present == 1);
+        CHECK(arr.allocated_pages() == 1);
+
+        auto it = arr.begin();
+
+        *it = value{2};
+        CHECK(arr.contains(0));
+        CHECK(arr.live_count() == 2);
+        CHECK(!view[1].has_value());
+        CHECK(!view[ecs::sparse_array<value>::page_size].has_value());
+    }
+
+    void mutable_reads_keep_pages()
+    {
+        ecs::sparse_array<tracked> arr;
+        std::size_t far = 1000000;
+        std::size_t present = 0;
+
+        arr.insert_at(far, tracked{1});
+        arr.set_tick(2);
+        for (std::size_t i = 0; i < arr.size(); i++) {
+            if (arr[i])
+                arr[i]->v++;
+        }
+        for (auto &&slot : arr)
+            present += slot.has_value();
+        for (auto it = arr.begin(); it != arr.end(); ++it)
+            present += it->has_value();
+        CHECK(present == 2);
+        CHECK(arr.allocated_pages() == 1);
+        CHECK(arr.live_count() == 1);
+        CHECK(arr.get(far).v == 2);
+        CHECK(arr.changes(1) == std::vector<std::size_t>{far});
+        arr[0] = tracked{3};
+        CHECK(arr.allocated_pages() == 2);
+        CHECK(arr.live_count() == 2);
+    }
+
+    void snapshot_counts()
+    {
+        ecs::sparse_array<value> arr;
+        ecs::sparse_array<value> copy;
+        std::vector<std::byte> buffer;
+        ecs::binary_writer writer(buffer);
+
+        arr.insert_at(1, value{1});
+        arr.reserve(8);
+        arr[7] = value{7};
+        arr.snapshot(writer);
+
+        ecs::binary_reader reader(buffer);
+
+        copy.restore(reader);
+        CHECK(copy.live_count() == 2);
+        CHECK(copy.contains(7) && copy.get(7).v == 7);
+    }
+
+    void index_of_components()
+    {
+        using array = ecs::sparse_array<value>;
+        array values;
+        array other;
+        std::size_t const indexes[] = {0, 1, array::page_size - 1, array::page_size, 5 * array::page_size + 3, 100000};
+
+        for (std::size_t idx : indexes)
+            values.insert_at(idx, value{int(idx)});
+        other.insert_at(0, value{0});
+        other.insert_at(100000, value{0});
+        for (std::size_t idx : indexes)
+            CHECK(values.get_index(std::as_const(values)[idx]) == idx);
+
+        array copy = values;
+
+        CHECK(values.get_index(std::as_const(copy)[1]) == array::npos);
+        CHECK(copy.get_index(std::as_const(copy)[100000]) == 100000);
+        CHECK(values.get_index(std::as_const(values)[2]) == array::npos);
+        CHECK(values.get_index(std::as_const(values)[3 * array::page_size]) == array::npos);
+        CHECK(values.get_index(std::as_const(other)[0]) == array::npos);
+        CHECK(values.get_index(std::as_const(other)[100000]) == array::npos);
+
+        // values that are not slots of a sparse_array are not read as one
+        std::optional<value> local{value{1}};
+        auto heap = std::make_unique<std::optional<value>>(value{2});
+
+        CHECK(values.get_index(local) == array::npos);
+        CHECK(values.get_index(*heap) == array::npos);
+
+        // the index of the pages follows their release and a restore
+        values.erase(5 * array::page_size + 3);
+        values.release_empty_pages();
+        CHECK(values.get_index(std::as_const(values)[100000]) == 100000);
+
+        std::vector<std::byte> buffer;
+        ecs::binary_writer writer(buffer);
+
+        values.snapshot(writer);
+        ecs::binary_reader reader(buffer);
+        array restored;
+
+        restored.restore(reader);
+        CHECK(restored.get_index(std::as_const(restored)[array::page_size]) == array::page_size);
+        CHECK(restored.get_index(std::as_const(values)[array::page_size]) == array::npos);
+    }
+}
+
+int main()
+{
+    assign_through_operator();
+    iterate_unallocated_pages();
+    mutable_reads_keep_pages();
+    snapshot_counts();
+    index_of_components();
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** spatial_grid test
+*/
+
+// Tests of the spatial grid: sync from the change logs gives the same grid as a rebuild, invalid boxes are rejected.
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include "Check.hpp"
+#include "Parallel.hpp"
+#include "Registry.hpp"
+#include "Spatial_grid.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct position { float x, y; };
+    struct body { float x, y; };
+}
+
+template <> struct ecs::track_changes<position> : std::true_type {};
+template <> struct ecs::track_changes<body> : std::true_type {};
+template <> struct ecs::component_storage<body> { using type = ecs::packed_array<body>; };
+
+namespace {
+    template <class Component> ecs::aabb box_of(std::size_t, Component const &c)
+    {
+        return ecs::aabb{c.x, c.y, c.x + 4, c.y + 4};
+    }
+
+    template <class Component> bool same_as_rebuild(ecs::spatial_grid const &grid, ecs::registry &reg)
+    {
+        ecs::spatial_grid expected(grid.cell_size());
+        auto const &components = reg.get_components<Component>();
+
+        expected.rebuild(components, box_of<Component>);
+        if (expected.size() != grid.size())
+            return false;
+        for (std::size_t e = 0; e < reg.stats().entities; e++) {
+            if (expected.contains(e) != grid.contains(e))
+                return false;
+            if (expected.contains(e) && (expected.box(e).min_x != grid.box(e).min_x || expected.box(e).min_y != grid.box(e).min_y))
+                return false;
+        }
+        return true;
+    }
+
+    template <class Component> void sync_follows_changes()
+    {
+        ecs::registry reg;
+        ecs::spatial_grid grid(16.f);
+        std::vector<ecs::entity> entities;
+        ecs::tick_t last_sync = 0;
+        ecs::thread_pool pool(4);
+
+        reg.register_component<Component>();
+        for (int i = 0; i < 10000; i++) {
+            ecs::entity e = reg.spawn_entity();
+
+            reg.add_component(e, Component{float(i % 100) * 10, float(i / 100) * 10});
+            entities.push_back(e);
+        }
+        for (int frame = 0; frame < 6; frame++) {
+            reg.run_systems(entities);
+            // a few entities move, are removed or come back
+            auto &components = reg.get_components<Component>();
+
+            for (std::size_t i = frame; i < entities.size(); i += 97) {
+                if (components.contains(entities[i]))
+                    components.get(entities[i]).x += 5;
+            }
+            for (std::size_t i = frame * 13; i < entities.size(); i += 1013)
+                reg.remove_component<Component>(entities[i]);
+            if (frame == 3)
+                reg.add_component(entities[0], Component{-50, -50});
+            // and every entity moves in parallel on the last frame
+            if (frame == 5)
+                ecs::par_for_each(ecs::zipper(components), [](std::size_t, Component &c) { c.y += 1; }, 64, pool);
+            grid.sync(components, last_sync, box_of<Component>);
+            last_sync = reg.tick();
+            CHECK(same_as_rebuild<Component>(grid, reg));
+        }
+    }
+
+    void invalid_boxes()
+    {
+        ecs::spatial_grid grid(1.f);
+        float nan = std::numeric_limits<float>::quiet_NaN();
+        float huge = 1e30f;
+        int thrown = 0;
+
+        for (ecs::aabb box : {ecs::aabb{nan, 0, 1, 1}, ecs::aabb{0, 0, huge, 1}, ecs::aabb{-huge, 0, 1, 1},
+                 ecs::aabb{2, 0, 1, 1}, ecs::aabb{0, 1, 1, 0}, ecs::aabb{-1e6f, -1e6f, 1e6f, 1e6f}}) {
+            try {
+                grid.update(0, box);
+            } catch (std::out_of_range const &) {
+                thrown++;
+            }
+        }
+        CHECK(thrown == 6);
+        CHECK(grid.size() == 0);
+        grid.update(0, ecs::aabb{0, 0, 1, 1});
+        grid.update(1, ecs::aabb{1e6f, 1e6f, 1e6f + 1, 1e6f + 1});
+        CHECK(grid.size() == 2);
+        // a query covering far more cells than the grid uses
+        CHECK(grid.query_aabb(ecs::aabb{-1e8f, -1e8f, 1e8f, 1e8f}).size() == 2);
+        CHECK(grid.query_aabb(ecs::aabb{-1e8f, -1e8f, 10, 10}) == std::vector<std::size_t>{0});
+
+        // a box spanning the whole range of the cells is rejected for its cell count
+        float limit = static_cast<float>(ecs::spatial_grid::max_cell);
+        std::string error;
+
+        try {
+            grid.update(2, ecs::aabb{-limit, -limit, limit, limit});
+        } catch (std::out_of_range const &e) {
+            error = e.what();
+        }
+        CHECK(error.find("max_box_cells") != std::string::npos);
+        CHECK(grid.size() == 2);
+        CHECK(grid.query_aabb(ecs::aabb{-limit, -limit, limit, limit}).size() == 2);
+    }
+}
+
+int main()
+{
+    sync_follows_changes<position>();
+    sync_follows_changes<body>();
+    invalid_boxes();
+    return check::failures() ? 1 : 0;
+}
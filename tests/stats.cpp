@@ -0,0 +1,73 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** stats test
+*/
+
+// Tests of registry::stats: readable pool names, live counts, memory of a small pool.
+
+#include "Check.hpp"
+#include "Registry.hpp"
+
+struct position { float x, y; };
+struct flag {};
+
+namespace game {
+    struct velocity { float x, y; };
+}
+
+namespace {
+    // MSVC does not mangle the names but prefixes them with struct or class
+    bool named(ecs::pool_stats const &pool, std::string const &name)
+    {
+        return pool.name == name || pool.name == "struct " + name;
+    }
+}
+
+int main()
+{
+    ecs::registry reg;
+
+    reg.register_component<position>();
+    reg.register_component<game::velocity>();
+    reg.register_component<flag>();
+    for (int i = 0; i < 10; i++) {
+        ecs::entity e = reg.spawn_entity();
+
+        reg.add_component(e, position{0, 0});
+        if (i % 2)
+            reg.add_component(e, game::velocity{1, 1});
+        if (i % 4 == 0)
+            reg.add_component(e, flag{});
+    }
+
+    ecs::registry_stats stats = reg.stats();
+    bool found_position = false;
+    bool found_velocity = false;
+    bool found_flag = false;
+
+    for (auto const &pool : stats.pools) {
+        if (named(pool, "position")) {
+            found_position = true;
+            CHECK(pool.live == 10);
+        }
+        if (named(pool, "game::velocity")) {
+            found_velocity = true;
+            CHECK(pool.live == 5);
+        }
+        // a few tags take one page sized for the tag, not for a large component
+        if (named(pool, "flag")) {
+            found_flag = true;
+            CHECK(pool.live == 3);
+            CHECK(pool.slots == ecs::sparse_array<flag>::page_size);
+            CHECK(ecs::sparse_array<flag>::page_bytes <= 2048);
+            CHECK(pool.bytes < 2 * ecs::sparse_array<flag>::page_bytes);
+        }
+    }
+    CHECK(found_position);
+    CHECK(found_velocity);
+    CHECK(found_flag);
+    CHECK(stats.alive == 10);
+    return check::failures() ? 1 : 0;
+}
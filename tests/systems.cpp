@@ -0,0 +1,115 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** systems test
+*/
+
+// Tests of the parallel systems: systems of a priority level only reading a component run at the same time, a system
+// writing a component another one uses runs alone in the order it was added, and so does a system without components.
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Check.hpp"
+#include "Registry.hpp"
+
+namespace {
+    struct position { int x; };
+    struct velocity { int x; };
+
+    // records the systems running, in the order they start
+    struct tracker {
+        std::atomic<int> running{0};
+        std::atomic<int> arrived{0}; /**< systems which started waiting for the others */
+        std::mutex mutex;
+        std::vector<std::string> started;
+        std::vector<std::string> overlapped;
+
+        void enter(std::string const &name)
+        {
+            running++;
+            std::lock_guard<std::mutex> lock(mutex);
+            started.push_back(name);
+        }
+        // a system running alone waits a bit to let another one start by mistake
+        void alone(std::string const &name)
+        {
+            enter(name);
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            if (running != 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                overlapped.push_back(name);
+            }
+            running--;
+        }
+        // systems expected together wait for each other, they fail after a while if they are run one after the other
+        bool together(std::string const &name, int count)
+        {
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+
+            enter(name);
+            arrived++;
+            while (arrived < count && std::chrono::steady_clock::now() < deadline)
+                std::this_thread::yield();
+            running--;
+            return arrived >= count;
+        }
+    };
+
+    void readers_together()
+    {
+        ecs::registry reg;
+        tracker t;
+        std::atomic<int> met{0};
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.set_parallel_systems(2);
+        reg.add_system<position const, velocity>([&](ecs::registry &, std::vector<ecs::entity> &, auto const &, auto &) {
+            met += t.together("move", 2);
+        });
+        reg.add_system<position const>([&](ecs::registry &, std::vector<ecs::entity> &, auto const &) {
+            met += t.together("draw", 2);
+        });
+        reg.run_systems(entities);
+        CHECK(met == 2);
+    }
+
+    void writers_alone()
+    {
+        ecs::registry reg;
+        tracker t;
+        std::atomic<int> met{0};
+        std::vector<ecs::entity> entities;
+
+        reg.register_component<position>();
+        reg.register_component<velocity>();
+        reg.set_parallel_systems(3);
+        reg.add_system<position>([&](ecs::registry &, std::vector<ecs::entity> &, auto &) { t.alone("write"); });
+        reg.add_system<position const>([&](ecs::registry &, std::vector<ecs::entity> &, auto const &) {
+            met += t.together("read", 2);
+        });
+        reg.add_system<velocity, position const>([&](ecs::registry &, std::vector<ecs::entity> &, auto &, auto const &) {
+            met += t.together("accelerate", 2);
+        });
+        reg.add_system([&](ecs::registry &, std::vector<ecs::entity> &) { t.alone("exclusive"); });
+        // another priority level runs after the whole level
+        reg.add_system<velocity const>([&](ecs::registry &, std::vector<ecs::entity> &, auto const &) { t.alone("next level"); }, 1);
+        reg.run_systems(entities);
+
+        CHECK(t.started.size() == 5 && t.overlapped.empty() && met == 2);
+        CHECK(t.started.front() == "write" && t.started[3] == "exclusive" && t.started.back() == "next level");
+    }
+}
+
+int main()
+{
+    readers_together();
+    writers_alone();
+    return check::failures() ? 1 : 0;
+}
@@ -0,0 +1,73 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** thread_pool test
+*/
+
+// Tests of the thread_pool: every submitted task runs once, tasks submitting and waiting for other tasks do not deadlock,
+// with one worker and with several.
+
+#include <atomic>
+#include "Check.hpp"
+#include "Thread_pool.hpp"
+
+namespace {
+    void submit_many(ecs::thread_pool &pool)
+    {
+        std::atomic<int> done{0};
+        std::atomic<int> sum{0};
+
+        for (int i = 0; i < 10000; i++) {
+            pool.submit([&done, &sum, i]() {
+                sum += i;
+                done++;
+            });
+        }
+        pool.wait_until([&done]() { return done == 10000; });
+        CHECK(sum == 10000 * 9999 / 2);
+    }
+
+    // each task splits its range in two tasks and waits for them, from inside the pool
+    int nested_sum(ecs::thread_pool &pool, int first, int last)
+    {
+        if (last - first <= 16) {
+            int sum = 0;
+
+            for (int i = first; i < last; i++)
+                sum += i;
+            return sum;
+        }
+        int middle = first + (last - first) / 2;
+        std::atomic<int> left{-1};
+        std::atomic<int> right{-1};
+
+        pool.submit([&pool, &left, first, middle]() { left = nested_sum(pool, first, middle); });
+        pool.submit([&pool, &right, middle, last]() { right = nested_sum(pool, middle, last); });
+        pool.wait_until([&left, &right]() { return left >= 0 && right >= 0; });
+        return left + right;
+    }
+
+    void nested_submit(ecs::thread_pool &pool)
+    {
+        std::atomic<int> result{-1};
+
+        pool.submit([&pool, &result]() { result = nested_sum(pool, 0, 4096); });
+        pool.wait_until([&result]() { return result >= 0; });
+        CHECK(result == 4096 * 4095 / 2);
+    }
+}
+
+int main()
+{
+    for (std::size_t workers : {1, 4}) {
+        ecs::thread_pool pool(workers);
+
+        CHECK(pool.size() == workers);
+        for (int pass = 0; pass < 20; pass++) {
+            submit_many(pool);
+            nested_submit(pool);
+        }
+    }
+    return check::failures() ? 1 : 0;
+}
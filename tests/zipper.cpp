@@ -0,0 +1,114 @@
+/*
+** EPITECH PROJECT, 2023
+** engine
+** File description:
+** zipper test
+*/
+
+// Tests of the zipper: the container with the shortest walk drives the iteration, the without filter rejects the
+// entities having its component, the joined entities are the same whatever the driver.
+
+#include <algorithm>
+#include <vector>
+#include "Check.hpp"
+#include "Packed_array.hpp"
+#include "Sparse_array.hpp"
+#include "Zipper.hpp"
+
+namespace {
+    struct position { int x; };
+    struct velocity { int x; };
+    struct frozen { bool on; };
+
+    template <class Zipper> std::vector<std::size_t> visited(Zipper &&zip)
+    {
+        std::vector<std::size_t> ids;
+
+        for (auto &&values : zip)
+            ids.push_back(std::get<0>(values));
+        return ids;
+    }
+
+    void shortest_walk_drives()
+    {
+        ecs::sparse_array<position> positions;
+        ecs::packed_array<velocity> velocities;
+
+        for (std::size_t i = 0; i < 1000; i++)
+            positions.insert_at(i, position{int(i)});
+        // inserted in reverse, so the walk of the packed_array is in decreasing order
+        for (std::size_t i = 0; i < 5; i++)
+            velocities.insert_at(900 - i * 100, velocity{int(i)});
+
+        auto zip = ecs::zipper(positions, velocities);
+
+        CHECK(zip.size() == velocities.live_count());
+        CHECK(visited(zip) == (std::vector<std::size_t>{900, 800, 700, 600, 500}));
+
+        // a sparse_array walks its whole index range, so a packed_array with more components can still drive
+        for (std::size_t i = 1000; i < 3000; i++)
+            velocities.insert_at(i, velocity{int(i)});
+        auto driven = ecs::zipper(positions, velocities);
+
+        CHECK(driven.size() == positions.size());
+        CHECK(visited(driven) == (std::vector<std::size_t>{500, 600, 700, 800, 900}));
+    }
+
+    void sparse_of_different_sizes()
+    {
+        ecs::sparse_array<position> few;
+        ecs::sparse_array<velocity> many;
+
+        // few components on a wide index range, many components on a short one
+        for (std::size_t i = 0; i < 10; i++)
+            few.insert_at(999990 + i, position{int(i)});
+        few.insert_at(42, position{42});
+        for (std::size_t i = 0; i < 1000; i++)
+            many.insert_at(i, velocity{int(i)});
+
+        auto zip = ecs::zipper(few, many);
+
+        CHECK(few.live_count() < many.live_count());
+        CHECK(zip.size() == many.size());
+        CHECK(visited(zip) == std::vector<std::size_t>{42});
+        CHECK(visited(ecs::zipper(many, few)) == std::vector<std::size_t>{42});
+    }
+
+    void without_filter()
+    {
+        ecs::sparse_array<position> positions;
+        ecs::packed_array<velocity> velocities;
+        ecs::sparse_array<frozen> frozens;
+        std::vector<std::size_t> expected;
+
+        for (std::size_t i = 0; i < 200; i++) {
+            positions.insert_at(i, position{int(i)});
+            if (i % 2 == 0)
+                velocities.insert_at(i, velocity{int(i)});
+            if (i % 3 == 0)
+                frozens.insert_at(i, frozen{true});
+            if (i % 2 == 0 && i % 3 != 0)
+                expected.push_back(i);
+        }
+        std::vector<std::size_t> found;
+
+        for (auto [id, pos, vel] : ecs::zipper(positions, velocities, ecs::without(frozens))) {
+            CHECK(pos.x == int(id) && vel.x == int(id));
+            found.push_back(id);
+        }
+        std::sort(found.begin(), found.end());
+        CHECK(found == expected);
+        // the filter never drives, even when its container is the smallest
+        ecs::sparse_array<frozen> none;
+
+        CHECK(visited(ecs::zipper(positions, ecs::without(none))).size() == 200);
+    }
+}
+
+int main()
+{
+    shortest_walk_drives();
+    sparse_of_different_sizes();
+    without_filter();
+    return check::failures() ? 1 : 0;
+}